@@ -22,6 +22,61 @@ static u64 page(u64 val) {
   return val & ~(u64)0xfff;
 }
 
+static bool is_adrp(u32 insn) {
+  return (insn & 0x9f000000) == 0x90000000;
+}
+
+static bool is_add_imm(u32 insn) {
+  return (insn & 0xffc00000) == 0x91000000;
+}
+
+static bool is_ldr_imm(u32 insn) {
+  return (insn & 0xffc00000) == 0xf9400000;
+}
+
+static bool is_adr_reachable(i64 val) {
+  return -((i64)1 << 20) <= val && val < ((i64)1 << 20);
+}
+
+// Compilers materialize an address with a pair of instructions, e.g.
+// `adrp x0, foo` followed by `add x0, x0, :lo12:foo`. Returns true if
+// the relocations at `i` and `i + 1` form such a pair. The second
+// instruction must use the register the first one sets and overwrite
+// it, so that we can rewrite the pair without changing any other
+// register.
+static bool is_insn_pair(std::span<ElfRel<E>> rels, i64 i, u8 *base,
+                         u32 type1, u32 type2) {
+  if (i + 1 >= rels.size())
+    return false;
+
+  const ElfRel<E> &r1 = rels[i];
+  const ElfRel<E> &r2 = rels[i + 1];
+
+  if (r1.r_type != type1 || r2.r_type != type2 ||
+      r1.r_sym != r2.r_sym || r1.r_addend != r2.r_addend ||
+      r1.r_offset + 4 != r2.r_offset)
+    return false;
+
+  u32 insn1 = *(u32 *)(base + r1.r_offset);
+  u32 insn2 = *(u32 *)(base + r2.r_offset);
+  u32 reg = insn1 & 0x1f;
+
+  return is_adrp(insn1) && (is_add_imm(insn2) || is_ldr_imm(insn2)) &&
+         ((insn2 >> 5) & 0x1f) == reg && (insn2 & 0x1f) == reg;
+}
+
+// Returns true if a GOT-loading `adrp` + `ldr` pair at `i` can be
+// rewritten to `adrp` + `add` that computes the symbol address directly.
+static bool is_relaxable_got_load(Context<E> &ctx, Symbol<E> &sym,
+                                  std::span<ElfRel<E>> rels, i64 i,
+                                  u8 *base) {
+  return ctx.arg.relax && !sym.is_imported && sym.is_relative() &&
+         sym.get_type() != STT_GNU_IFUNC && rels[i].r_addend == 0 &&
+         is_insn_pair(rels, i, base, R_AARCH64_ADR_GOT_PAGE,
+                      R_AARCH64_LD64_GOT_LO12_NC) &&
+         is_ldr_imm(*(u32 *)(base + rels[i + 1].r_offset));
+}
+
 template <>
 void GotPltSection<E>::copy_buf(Context<E> &ctx) {
   u64 *buf = (u64 *)(ctx.buf + this->shdr.sh_offset);
@@ -156,14 +211,16 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
                    << lo << ", " << hi << ")";
     };
 
-#define S   (frag_ref ? frag_ref->frag->get_addr(ctx) : sym.get_addr(ctx))
+#define S   (frag_ref ? frag_ref->frag->get_addr(ctx) \
+                      : file.symbol_addrs[rel.r_sym])
 #define A   (frag_ref ? frag_ref->addend : rel.r_addend)
-#define P   (output_section->shdr.sh_addr + offset + rel.r_offset)
+#define P   (get_addr() + rel.r_offset)
 #define G   (sym.get_got_addr(ctx) - ctx.got->shdr.sh_addr)
 #define GOT ctx.got->shdr.sh_addr
 
     if (needs_dynrel[i]) {
-      *dynrel++ = {P, R_AARCH64_ABS64, (u32)sym.get_dynsym_idx(ctx), A};
+      if (!ctx.arg.pack_dyn_relocs_android)
+        *dynrel++ = {P, R_AARCH64_ABS64, (u32)sym.get_dynsym_idx(ctx), A};
       *(u64 *)loc = A;
       continue;
     }
@@ -210,12 +267,55 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       *(u32 *)loc |= bits(S + A, 63, 48) << 5;
       continue;
     case R_AARCH64_ADR_GOT_PAGE: {
+      if (sym.get_got_idx(ctx) == -1) {
+        // The GOT load was relaxed by scan_relocations(), so compute
+        // the symbol address directly.
+        //
+        //   adrp xN, :got:foo; ldr xN, [xN, :got_lo12:foo]
+        //   -> adrp xN, foo; add xN, xN, :lo12:foo
+        //   -> adr xN, foo; nop  (if foo is within +-1 MiB)
+        u32 reg = *(u32 *)loc & 0x1f;
+        i64 val = S + A - P;
+
+        if (is_adr_reachable(val)) {
+          *(u32 *)loc = 0x10000000 | reg;
+          write_adr(loc, val);
+          *(u32 *)(loc + 4) = 0xd503201f;
+        } else {
+          val = page(S + A) - page(P);
+          overflow_check(val, -((i64)1 << 32), (i64)1 << 32);
+          write_adr(loc, bits(val, 32, 12));
+          *(u32 *)(loc + 4) = 0x91000000 | (bits(S + A, 11, 0) << 10) |
+                              (reg << 5) | reg;
+        }
+
+        i++;
+        if (rel_fragments && rel_fragments[frag_idx].idx == i)
+          frag_idx++;
+        continue;
+      }
+
       i64 val = page(G + GOT + A) - page(P);
       overflow_check(val, -((i64)1 << 32), (i64)1 << 32);
       write_adr(loc, bits(val, 32, 12));
       continue;
     }
     case R_AARCH64_ADR_PREL_PG_HI21: {
+      // adrp xN, foo; add xN, xN, :lo12:foo -> adr xN, foo; nop
+      if (ctx.arg.relax && is_adr_reachable(S + A - P) &&
+          is_insn_pair(rels, i, base, R_AARCH64_ADR_PREL_PG_HI21,
+                       R_AARCH64_ADD_ABS_LO12_NC) &&
+          is_add_imm(*(u32 *)(loc + 4))) {
+        *(u32 *)loc = 0x10000000 | (*(u32 *)loc & 0x1f);
+        write_adr(loc, S + A - P);
+        *(u32 *)(loc + 4) = 0xd503201f;
+
+        i++;
+        if (rel_fragments && rel_fragments[frag_idx].idx == i)
+          frag_idx++;
+        continue;
+      }
+
       i64 val = page(S + A) - page(P);
       overflow_check(val, -((i64)1 << 32), (i64)1 << 32);
       write_adr(loc, bits(val, 32, 12));
@@ -357,10 +457,29 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
 template <>
 void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
   std::span<ElfRel<E>> rels = get_rels(ctx);
-  i64 frag_idx = 0;
+  i64 num_fast = 0;
 
   for (i64 i = 0; i < rels.size(); i++) {
     const ElfRel<E> &rel = rels[i];
+
+    // Most relocations in debug info sections are R_AARCH64_ABS32 or
+    // R_AARCH64_ABS64 against section symbols. Handle them first
+    // without looking up symbols or fragments. Relocations tend to
+    // refer symbols in random order, so we prefetch symbol addresses.
+    if (i + 16 < rels.size())
+      __builtin_prefetch(&file.symbol_addrs[rels[i + 16].r_sym]);
+
+    if ((rel.r_type == R_AARCH64_ABS64 || rel.r_type == R_AARCH64_ABS32) &&
+        !file.slow_reloc_syms[rel.r_sym]) {
+      u64 val = file.symbol_addrs[rel.r_sym] + rel.r_addend;
+      if (rel.r_type == R_AARCH64_ABS64)
+        *(u64 *)(base + rel.r_offset) = val;
+      else
+        *(u32 *)(base + rel.r_offset) = val;
+      num_fast++;
+      continue;
+    }
+
     if (rel.r_type == R_AARCH64_NONE)
       continue;
 
@@ -376,7 +495,7 @@ void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
     i64 addend;
     std::tie(frag, addend) = get_fragment(ctx, rel);
 
-#define S (frag ? frag->get_addr(ctx) : sym.get_addr(ctx))
+#define S (frag ? frag->get_addr(ctx) : file.symbol_addrs[rel.r_sym])
 #define A (frag ? addend : rel.r_addend)
 
     switch (rel.r_type) {
@@ -395,6 +514,9 @@ void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
 #undef S
 #undef A
   }
+
+  static Counter counter("reloc_nonalloc_fast");
+  counter += num_fast;
 }
 
 template <>
@@ -404,6 +526,8 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
   this->reldyn_offset = file.num_dynrel * sizeof(ElfRel<E>);
   std::span<ElfRel<E>> rels = get_rels(ctx);
 
+  u8 *base = (u8 *)contents.data();
+
   // Scan relocations
   for (i64 i = 0; i < rels.size(); i++) {
     const ElfRel<E> &rel = rels[i];
@@ -434,6 +558,12 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
       break;
     }
     case R_AARCH64_ADR_GOT_PAGE:
+      // A GOT load that is relaxed doesn't need a GOT slot.
+      if (is_relaxable_got_load(ctx, sym, rels, i, base))
+        i++;
+      else
+        sym.flags |= NEEDS_GOT;
+      break;
     case R_AARCH64_LD64_GOT_LO12_NC:
     case R_AARCH64_LD64_GOTPAGE_LO15:
       sym.flags |= NEEDS_GOT;
@@ -492,12 +622,16 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
   }
 }
 
-static void reset_thunk(RangeExtensionThunk<E> &thunk) {
-  for (Symbol<E> *sym : thunk.symbols) {
-    sym->thunk_idx = -1;
-    sym->thunk_sym_idx = -1;
-    sym->flags &= (u8)~NEEDS_THUNK;
-  }
+// Maps symbols to their locations in thunks. We don't store thunk
+// indices in Symbol itself because only a tiny fraction of symbols need
+// thunks, and keeping Symbol small matters more. This map is updated
+// only in serial parts of create_thunks(), so lookups from parallel
+// loops are safe.
+using ThunkSymbolMap = std::unordered_map<Symbol<E> *, RangeExtensionRef>;
+
+static void reset_thunk(RangeExtensionThunk<E> &thunk, ThunkSymbolMap &map) {
+  for (Symbol<E> *sym : thunk.symbols)
+    map.erase(sym);
 }
 
 static bool is_reachable(Context<E> &ctx, Symbol<E> &sym,
@@ -518,21 +652,68 @@ static bool is_reachable(Context<E> &ctx, Symbol<E> &sym,
   return -(1 << 27) <= val && val < (1 << 27);
 }
 
+// Addresses outside of the output section being processed may move
+// by up to this amount after thunks are inserted.
+static constexpr i64 LAYOUT_MARGIN = 16 * 1024 * 1024;
+
+// Similar to is_reachable, but this function is used while we are
+// creating thunks for multiple output sections in parallel. Since
+// input section offsets in other output sections are being updated
+// by other threads, we don't look at them. Instead, we check if the
+// entire target output section is within reach. Output section
+// addresses are estimates at this point, so we require some margin.
+static bool is_reachable_estimated(Context<E> &ctx, Symbol<E> &sym,
+                                   InputSection<E> &isec,
+                                   const ElfRel<E> &rel) {
+  bool is_plt = sym.has_plt(ctx) &&
+                (sym.is_imported || sym.get_type() == STT_GNU_IFUNC);
+  InputSection<E> *target = sym.input_section;
+
+  if (!is_plt && target && target->output_section == isec.output_section)
+    return is_reachable(ctx, sym, isec, rel);
+
+  if (sym.is_absolute())
+    return false;
+
+  i64 lo;
+  i64 hi;
+
+  if (is_plt || sym.get_frag()) {
+    lo = hi = sym.get_addr(ctx);
+  } else if (target && target->output_section) {
+    lo = target->output_section->shdr.sh_addr;
+    hi = lo + target->output_section->shdr.sh_size;
+  } else {
+    return false;
+  }
+
+  i64 A = rel.r_addend;
+  i64 P = isec.get_addr() + rel.r_offset;
+  return -(1 << 27) + LAYOUT_MARGIN <= lo + A - P &&
+         hi + A - P < (1 << 27) - LAYOUT_MARGIN;
+}
+
 // We create a thunk no further than 100 MiB from any section.
 constexpr i64 MAX_DISTANCE = 100 * 1024 * 1024;
 
 // We create a thunk for each 10 MiB input sections.
 static constexpr i64 GROUP_SIZE = 10 * 1024 * 1024;
 
-static void create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
+// Creates thunks for a given output section and returns the new
+// section size. This function may be called for multiple output
+// sections in parallel, so it must not modify anything that belongs
+// to other output sections.
+static i64 create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
   std::span<InputSection<E> *> members = osec.members;
-  members[0]->offset = 0;
+  members[0]->set_offset(0);
+
+  ThunkSymbolMap thunk_syms;
 
   // Initialize input sections with very large dummy offsets so that
   // sections that have got real offsets are separated from the ones
   // without in the virtual address space.
   tbb::parallel_for((i64)1, (i64)members.size(), [&](i64 i) {
-    members[i]->offset = 1 << 31;
+    members[i]->set_offset((u64)1 << 31);
   });
 
   // We create thunks from the beginning of the section to the end.
@@ -546,24 +727,25 @@ static void create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
 
   while (b < members.size()) {
     // Move D foward as far as we can jump from B to D.
-    while (d < members.size() && offset - members[b]->offset < MAX_DISTANCE) {
+    while (d < members.size() &&
+           offset - members[b]->get_offset() < MAX_DISTANCE) {
       offset = align_to(offset, members[d]->shdr.sh_addralign);
-      members[d]->offset = offset;
+      members[d]->set_offset(offset);
       offset += members[d]->shdr.sh_size;
       d++;
     }
 
     // Move C forward so that C is apart from B by GROUP_SIZE.
     while (c < members.size() &&
-           members[c]->offset - members[b]->offset < GROUP_SIZE)
+           members[c]->get_offset() - members[b]->get_offset() < GROUP_SIZE)
       c++;
 
     // Move A forward so that A is reachable from C.
     if (c > 0) {
-      i64 c_end = members[c - 1]->offset + members[c - 1]->shdr.sh_size;
+      i64 c_end = members[c - 1]->get_offset() + members[c - 1]->shdr.sh_size;
       while (a < osec.thunks.size() &&
              osec.thunks[a]->offset < c_end - MAX_DISTANCE)
-        reset_thunk(*osec.thunks[a++]);
+        reset_thunk(*osec.thunks[a++], thunk_syms);
     }
 
     // Create a thunk for input sections between B and C and place it at D.
@@ -576,8 +758,11 @@ static void create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
     // Scan relocations between B and C to collect symbols that need thunks.
     tbb::parallel_for_each(&members[b], &members[c], [&](InputSection<E> *isec) {
       std::span<ElfRel<E>> rels = isec->get_rels(ctx);
+      isec->range_extn.clear();
       isec->range_extn.resize(rels.size());
 
+      std::vector<Symbol<E> *> syms;
+
       for (i64 i = 0; i < rels.size(); i++) {
         const ElfRel<E> &rel = rels[i];
         if (rel.r_type != R_AARCH64_CALL26 && rel.r_type != R_AARCH64_JUMP26)
@@ -586,37 +771,39 @@ static void create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
         Symbol<E> &sym = *isec->file.symbols[rel.r_sym];
 
         // Skip if the destination is within reach.
-        if (is_reachable(ctx, sym, *isec, rel))
+        if (is_reachable_estimated(ctx, sym, *isec, rel))
           continue;
 
         // If the symbol is already in another thunk, reuse it.
-        if (sym.thunk_idx != -1) {
-          isec->range_extn[i] = {sym.thunk_idx, sym.thunk_sym_idx};
+        if (auto it = thunk_syms.find(&sym); it != thunk_syms.end()) {
+          isec->range_extn[i] = it->second;
           continue;
         }
 
-        // Otherwise, add the symbol to this thunk if it's not added already.
+        // Otherwise, add the symbol to this thunk.
         isec->range_extn[i] = {thunk.thunk_idx, -1};
+        syms.push_back(&sym);
+      }
 
-        if (!(sym.flags.fetch_or(NEEDS_THUNK) & NEEDS_THUNK)) {
-          std::scoped_lock lock(thunk.mu);
-          thunk.symbols.push_back(&sym);
-        }
+      if (!syms.empty()) {
+        std::scoped_lock lock(thunk.mu);
+        append(thunk.symbols, syms);
       }
     });
 
+    // Sort symbols added to the thunk to make the output deterministic,
+    // and remove duplicates.
+    sort(thunk.symbols, [](Symbol<E> *a, Symbol<E> *b) { return *a < *b; });
+    thunk.symbols.erase(std::unique(thunk.symbols.begin(), thunk.symbols.end()),
+                        thunk.symbols.end());
+
     // Now that we know the number of symbols in the thunk, we can compute
     // its size.
     offset += thunk.size();
 
-    // Sort symbols added to the thunk to make the output deterministic.
-    sort(thunk.symbols, [](Symbol<E> *a, Symbol<E> *b) { return *a < *b; });
-
     // Assign offsets within the thunk to the symbols.
-    for (i64 i = 0; Symbol<E> *sym : thunk.symbols) {
-      sym->thunk_idx = thunk.thunk_idx;
-      sym->thunk_sym_idx = i++;
-    }
+    for (i64 i = 0; i < thunk.symbols.size(); i++)
+      thunk_syms[thunk.symbols[i]] = {thunk.thunk_idx, (i32)i};
 
     // Scan relocations again to fix symbol offsets in the last thunk.
     tbb::parallel_for_each(&members[b], &members[c], [&](InputSection<E> *isec) {
@@ -626,8 +813,8 @@ static void create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
         RangeExtensionRef &ref = isec->range_extn[i];
 
         if (ref.thunk_idx == thunk.thunk_idx) {
-          Symbol<E> &sym = *isec->file.symbols[rels[i].r_sym];
-          ref.sym_idx = sym.thunk_sym_idx;
+          Symbol<E> *sym = isec->file.symbols[rels[i].r_sym];
+          ref.sym_idx = thunk_syms.at(sym).sym_idx;
         }
       }
     });
@@ -637,9 +824,9 @@ static void create_thunks(Context<E> &ctx, OutputSection<E> &osec) {
   }
 
   while (a < osec.thunks.size())
-    reset_thunk(*osec.thunks[a++]);
+    reset_thunk(*osec.thunks[a++], thunk_syms);
 
-  osec.shdr.sh_size = offset;
+  return offset;
 }
 
 static void mark_thunk_symbols(Context<E> &ctx, OutputSection<E> &osec) {
@@ -693,13 +880,13 @@ static void shrink_section(Context<E> &ctx, OutputSection<E> &osec) {
 
   auto add_isec = [&]() {
     offset = align_to(offset, members[0]->shdr.sh_addralign);
-    members[0]->offset = offset;
+    members[0]->set_offset(offset);
     offset += members[0]->shdr.sh_size;
     members = members.subspan(1);
   };
 
   while (!thunks.empty() && !members.empty()) {
-    if (thunks[0]->offset < members[0]->offset)
+    if (thunks[0]->offset < members[0]->get_offset())
       add_thunk();
     else
       add_isec();
@@ -714,28 +901,45 @@ static void shrink_section(Context<E> &ctx, OutputSection<E> &osec) {
   osec.shdr.sh_size = offset;
 }
 
-// ARM64's call/jump instructions take 27 bits displacement, so they
-// can refer only up to ±128 MiB. If a branch target is further than
-// that, we need to let it branch to a linker-synthesized code
-// sequence that construct a full 32 bit address in a register and
-// jump there. That linker-synthesized code is called "thunk".
-i64 create_range_extension_thunks(Context<E> &ctx) {
-  Timer t(ctx, "create_range_extension_thunks");
+// Returns true if all branches that don't use thunks are within reach
+// in the current file layout.
+static bool verify_thunks(Context<E> &ctx, OutputSection<E> &osec) {
+  std::atomic_bool ok = true;
+
+  tbb::parallel_for_each(osec.members, [&](InputSection<E> *isec) {
+    std::span<ElfRel<E>> rels = isec->get_rels(ctx);
 
-  // First, we create thunks with a pessimistic assumption that all
-  // out-of-section relocations would need thunks. To do so, we start
-  // with an initial layout in which output sections are separated far
-  // apart.
-  for (i64 i = 0; Chunk<E> *chunk : ctx.chunks)
-    chunk->shdr.sh_addr = i++ << 31;
+    for (i64 i = 0; i < rels.size(); i++) {
+      const ElfRel<E> &rel = rels[i];
+      if (rel.r_type != R_AARCH64_CALL26 && rel.r_type != R_AARCH64_JUMP26)
+        continue;
 
-  std::vector<OutputSection<E> *> sections;
-  for (std::unique_ptr<OutputSection<E>> &osec : ctx.output_sections)
-    if (!osec->members.empty() && (osec->shdr.sh_flags & SHF_EXECINSTR))
-      sections.push_back(osec.get());
+      Symbol<E> &sym = *isec->file.symbols[rel.r_sym];
+      if (isec->range_extn[i].thunk_idx == -1 &&
+          !sym.esym().is_undef_weak() &&
+          !is_reachable(ctx, sym, *isec, rel)) {
+        ok = false;
+        return;
+      }
+    }
+  });
+  return ok;
+}
 
+static bool
+do_create_range_extension_thunks(Context<E> &ctx,
+                                 std::span<OutputSection<E> *> sections) {
   for (OutputSection<E> *osec : sections)
-    create_thunks(ctx, *osec);
+    osec->thunks.clear();
+
+  // Create thunks for each output section in parallel.
+  std::vector<i64> sizes(sections.size());
+  tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
+    sizes[i] = create_thunks(ctx, *sections[i]);
+  });
+
+  for (i64 i = 0; i < sections.size(); i++)
+    sections[i]->shdr.sh_size = sizes[i];
 
   // Recompute file layout.
   set_osec_offsets(ctx);
@@ -750,10 +954,65 @@ i64 create_range_extension_thunks(Context<E> &ctx) {
   // sizes must be equal to or smaller than previous values, so all
   // relocations that were previously reachable will still be reachable
   // after this step.
-  for (OutputSection<E> *osec : sections)
+  tbb::parallel_for_each(sections, [&](OutputSection<E> *osec) {
     shrink_section(ctx, *osec);
+  });
+
+  // Compute the final layout and check that branches that were
+  // estimated to be reachable are actually reachable.
+  set_osec_offsets(ctx);
+
+  for (OutputSection<E> *osec : sections)
+    if (!verify_thunks(ctx, *osec))
+      return false;
+  return true;
+}
+
+// ARM64's call/jump instructions take 27 bits displacement, so they
+// can refer only up to ±128 MiB. If a branch target is further than
+// that, we need to let it branch to a linker-synthesized code
+// sequence that construct a full 32 bit address in a register and
+// jump there. That linker-synthesized code is called "thunk".
+i64 create_range_extension_thunks(Context<E> &ctx) {
+  Timer t(ctx, "create_range_extension_thunks");
+
+  std::vector<OutputSection<E> *> sections;
+  for (std::unique_ptr<OutputSection<E>> &osec : ctx.output_sections)
+    if (!osec->members.empty() && (osec->shdr.sh_flags & SHF_EXECINSTR))
+      sections.push_back(osec.get());
+
+  // We use the current file layout, which doesn't contain thunks yet,
+  // as an estimate of the final layout. Branches to other output
+  // sections are considered reachable if they are reachable in the
+  // estimated layout with some margin.
+  //
+  // If the margin turns out to be insufficient, we redo it with a
+  // pessimistic assumption that all out-of-section branches need
+  // thunks. To do so, we use a layout in which output sections are
+  // separated far apart.
+  if (!do_create_range_extension_thunks(ctx, sections)) {
+    static Counter fallback("thunk_fallback");
+    fallback++;
+
+    for (i64 i = 0; Chunk<E> *chunk : ctx.chunks)
+      chunk->shdr.sh_addr = i++ << 31;
+
+    if (!do_create_range_extension_thunks(ctx, sections))
+      Fatal(ctx) << "failed to create range extension thunks";
+  }
+
+  static Counter num_thunks("thunks");
+  static Counter num_thunk_syms("thunk_symbols");
+
+  for (OutputSection<E> *osec : sections) {
+    for (std::unique_ptr<RangeExtensionThunk<E>> &thunk : osec->thunks) {
+      if (!thunk->symbols.empty()) {
+        num_thunks++;
+        num_thunk_syms += thunk->symbols.size();
+      }
+    }
+  }
 
-  // Compute the final layout.
   return set_osec_offsets(ctx);
 }
 
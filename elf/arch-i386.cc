@@ -172,14 +172,16 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       *(u32 *)loc = val;
     };
 
-#define S      (frag_ref ? frag_ref->frag->get_addr(ctx) : sym.get_addr(ctx))
+#define S      (frag_ref ? frag_ref->frag->get_addr(ctx) \
+                         : file.symbol_addrs[rel.r_sym])
 #define A      (frag_ref ? frag_ref->addend : this->get_addend(rel))
-#define P      (output_section->shdr.sh_addr + offset + rel.r_offset)
+#define P      ((u32)(get_addr() + rel.r_offset))
 #define G      (sym.get_got_addr(ctx) - ctx.got->shdr.sh_addr)
 #define GOTPLT ctx.gotplt->shdr.sh_addr
 
     if (needs_dynrel[i]) {
-      *dynrel++ = {P, R_386_32, (u32)sym.get_dynsym_idx(ctx)};
+      if (!ctx.arg.pack_dyn_relocs_android)
+        *dynrel++ = {P, R_386_32, (u32)sym.get_dynsym_idx(ctx)};
       write32(A);
       continue;
     }
@@ -321,7 +323,7 @@ void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
       *(u16 *)loc = val;
     };
 
-#define S      (frag ? frag->get_addr(ctx) : sym.get_addr(ctx))
+#define S      (frag ? frag->get_addr(ctx) : file.symbol_addrs[rel.r_sym])
 #define A      (frag ? addend : this->get_addend(rel))
 #define G      (sym.get_got_addr(ctx) - ctx.got->shdr.sh_addr)
 #define GOTPLT ctx.gotplt->shdr.sh_addr
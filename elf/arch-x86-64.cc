@@ -226,24 +226,18 @@ template <>
 void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
   ElfRel<E> *dynrel = nullptr;
   std::span<ElfRel<E>> rels = get_rels(ctx);
-  i64 frag_idx = 0;
 
   if (ctx.reldyn)
     dynrel = (ElfRel<E> *)(ctx.buf + ctx.reldyn->shdr.sh_offset +
                                 file.reldyn_offset + this->reldyn_offset);
 
-  for (i64 i = 0; i < rels.size(); i++) {
+  // Applies the i'th relocation. This is used for relocations that are
+  // not compiled to simple operations by scan_relocations().
+  auto apply_generic = [&](i64 i, const SectionFragmentRef<E> *frag_ref) {
     const ElfRel<E> &rel = rels[i];
-    if (rel.r_type == R_X86_64_NONE)
-      continue;
-
     Symbol<E> &sym = *file.symbols[rel.r_sym];
     u8 *loc = base + rel.r_offset;
 
-    const SectionFragmentRef<E> *frag_ref = nullptr;
-    if (rel_fragments && rel_fragments[frag_idx].idx == i)
-      frag_ref = &rel_fragments[frag_idx++];
-
     auto overflow_check = [&](i64 val, i64 lo, i64 hi) {
       if (val < lo || hi <= val)
         Error(ctx) << *this << ": relocation " << rel << " against "
@@ -285,80 +279,82 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       *(u64 *)loc = val;
     };
 
-#define S   (frag_ref ? frag_ref->frag->get_addr(ctx) : sym.get_addr(ctx))
+#define S   (frag_ref ? frag_ref->frag->get_addr(ctx) \
+                      : file.symbol_addrs[rel.r_sym])
 #define A   (frag_ref ? frag_ref->addend : rel.r_addend)
-#define P   (output_section->shdr.sh_addr + offset + rel.r_offset)
+#define P   (get_addr() + rel.r_offset)
 #define G   (sym.get_got_addr(ctx) - ctx.gotplt->shdr.sh_addr)
 #define GOT ctx.gotplt->shdr.sh_addr
 
     if (needs_dynrel[i]) {
-      *dynrel++ = {P, R_X86_64_64, (u32)sym.get_dynsym_idx(ctx), A};
+      if (!ctx.arg.pack_dyn_relocs_android)
+        *dynrel++ = {P, R_X86_64_64, (u32)sym.get_dynsym_idx(ctx), A};
       write64(A);
-      continue;
+      return;
     }
 
     if (needs_baserel[i]) {
       if (!is_relr_reloc(ctx, rel))
         *dynrel++ = {P, R_X86_64_RELATIVE, 0, (i64)(S + A)};
       write64(S + A);
-      continue;
+      return;
     }
 
     switch (rel.r_type) {
     case R_X86_64_8:
       write8(S + A);
-      continue;
+      return;
     case R_X86_64_16:
       write16(S + A);
-      continue;
+      return;
     case R_X86_64_32:
       write32(S + A);
-      continue;
+      return;
     case R_X86_64_32S:
       write32s(S + A);
-      continue;
+      return;
     case R_X86_64_64:
       write64(S + A);
-      continue;
+      return;
     case R_X86_64_PC8:
       write8s(S + A - P);
-      continue;
+      return;
     case R_X86_64_PC16:
       write16s(S + A - P);
-      continue;
+      return;
     case R_X86_64_PC32:
       write32s(S + A - P);
-      continue;
+      return;
     case R_X86_64_PC64:
       write64(S + A - P);
-      continue;
+      return;
     case R_X86_64_PLT32:
       write32s(S + A - P);
-      continue;
+      return;
     case R_X86_64_PLTOFF64:
       write64(S + A - GOT);
       break;
     case R_X86_64_GOT32:
       write32s(G + A);
-      continue;
+      return;
     case R_X86_64_GOT64:
       write64(G + A);
-      continue;
+      return;
     case R_X86_64_GOTOFF64:
       write64(S + A - GOT);
-      continue;
+      return;
     case R_X86_64_GOTPC32:
       write32s(GOT + A - P);
-      continue;
+      return;
     case R_X86_64_GOTPC64:
       write64(GOT + A - P);
-      continue;
+      return;
     case R_X86_64_GOTPCREL:
       write32s(G + GOT + A - P);
-      continue;
+      return;
     case R_X86_64_GOTPCREL64:
       write64(G + GOT + A - P);
-      continue;
+      return;
     case R_X86_64_GOTPCRELX:
       if (sym.get_got_idx(ctx) == -1) {
         u32 insn = relax_gotpcrelx(loc - 2);
@@ -368,7 +364,7 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       } else {
         write32s(G + GOT + A - P);
       }
-      continue;
+      return;
     case R_X86_64_REX_GOTPCRELX:
       if (sym.get_got_idx(ctx) == -1) {
         u32 insn = relax_rex_gotpcrelx(loc - 3);
@@ -379,7 +375,7 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       } else {
         write32s(G + GOT + A - P);
       }
-      continue;
+      return;
     case R_X86_64_TLSGD:
       if (sym.get_tlsgd_idx(ctx) == -1) {
         // Relax GD to LE
@@ -392,11 +388,10 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
         i64 val = S - ctx.tls_end + A + 4;
         overflow_check(val, -((i64)1 << 31), (i64)1 << 31);
         *(u32 *)(loc + 8) = val;
-        i++;
       } else {
         write32s(sym.get_tlsgd_addr(ctx) + A - P);
       }
-      continue;
+      return;
     case R_X86_64_TLSLD:
       if (ctx.got->tlsld_idx == -1) {
         // Relax LD to LE
@@ -405,29 +400,28 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
           0x64, 0x48, 0x8b, 0x04, 0x25, 0, 0, 0, 0, // mov %fs:0, %rax
         };
         memcpy(loc - 3, insn, sizeof(insn));
-        i++;
       } else {
         write32s(ctx.got->get_tlsld_addr(ctx) + A - P);
       }
-      continue;
+      return;
     case R_X86_64_DTPOFF32:
       if (ctx.arg.relax && !ctx.arg.shared)
         write32s(S + A - ctx.tls_end);
       else
         write32s(S + A - ctx.tls_begin);
-      continue;
+      return;
     case R_X86_64_DTPOFF64:
       if (ctx.arg.relax && !ctx.arg.shared)
         write64(S + A - ctx.tls_end);
       else
         write64(S + A - ctx.tls_begin);
-      continue;
+      return;
     case R_X86_64_TPOFF32:
       write32s(S + A - ctx.tls_end);
-      continue;
+      return;
     case R_X86_64_TPOFF64:
       write64(S + A - ctx.tls_end);
-      continue;
+      return;
     case R_X86_64_GOTTPOFF:
       if (sym.get_gottp_idx(ctx) == -1) {
         u32 insn = relax_gottpoff(loc - 3);
@@ -438,7 +432,7 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       } else {
         write32s(sym.get_gottp_addr(ctx) + A - P);
       }
-      continue;
+      return;
     case R_X86_64_GOTPC32_TLSDESC:
       if (sym.get_tlsdesc_idx(ctx) == -1) {
         static const u8 insn[] = {
@@ -449,20 +443,20 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
       } else {
         write32s(sym.get_tlsdesc_addr(ctx) + A - P);
       }
-      continue;
+      return;
     case R_X86_64_SIZE32:
       write32(sym.esym().st_size + A);
-      continue;
+      return;
     case R_X86_64_SIZE64:
       write64(sym.esym().st_size + A);
-      continue;
+      return;
     case R_X86_64_TLSDESC_CALL:
       if (sym.get_tlsdesc_idx(ctx) == -1) {
         // call *(%rax) -> nop
         loc[0] = 0x66;
         loc[1] = 0x90;
       }
-      continue;
+      return;
     default:
       unreachable();
     }
@@ -472,6 +466,75 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
 #undef P
 #undef G
 #undef GOT
+  };
+
+  // We don't keep relocations for simple operations, so we need to
+  // find the original one to report an error.
+  auto overflow_check = [&](const RelocOp &op, i64 val, i64 lo, i64 hi) {
+    if (lo <= val && val < hi) [[likely]]
+      return;
+
+    for (const ElfRel<E> &rel : rels) {
+      if (rel.r_offset == op.offset && rel.r_type != R_X86_64_NONE) {
+        Error(ctx) << *this << ": relocation " << rel << " against "
+                   << *file.symbols[rel.r_sym] << " out of range: " << val
+                   << " is not in [" << lo << ", " << hi << ")";
+        return;
+      }
+    }
+    unreachable();
+  };
+
+  u64 addr = get_addr();
+
+  for (const RelocOp &op : reloc_plan) {
+    if (op.kind == RelocOp::GENERIC) {
+      apply_generic(op.target, (op.addend == -1) ? nullptr
+                                                 : &rel_fragments[op.addend]);
+      continue;
+    }
+
+    u8 *loc = base + op.offset;
+    u64 S = op.is_frag ? rel_fragments[op.target].frag->get_addr(ctx)
+                       : file.symbol_addrs[op.target];
+    i64 A = op.addend;
+    u64 P = addr + op.offset;
+
+    switch (op.kind) {
+    case RelocOp::DYNREL:
+      *dynrel++ = {P, R_X86_64_64,
+                   (u32)file.symbols[op.target]->get_dynsym_idx(ctx), A};
+      *(u64 *)loc = A;
+      break;
+    case RelocOp::DYNREL_ANDROID:
+      *(u64 *)loc = A;
+      break;
+    case RelocOp::BASEREL:
+      *dynrel++ = {P, R_X86_64_RELATIVE, 0, (i64)(S + A)};
+      *(u64 *)loc = S + A;
+      break;
+    case RelocOp::BASEREL_RELR:
+    case RelocOp::ABS64:
+      *(u64 *)loc = S + A;
+      break;
+    case RelocOp::ABS32:
+      overflow_check(op, S + A, 0, (i64)1 << 32);
+      *(u32 *)loc = S + A;
+      break;
+    case RelocOp::ABS32S:
+      overflow_check(op, S + A, -((i64)1 << 31), (i64)1 << 31);
+      *(u32 *)loc = S + A;
+      break;
+    case RelocOp::PC32:
+      overflow_check(op, S + A - P, -((i64)1 << 31), (i64)1 << 31);
+      *(u32 *)loc = S + A - P;
+      break;
+    case RelocOp::PC64:
+      *(u64 *)loc = S + A - P;
+      break;
+    default:
+      unreachable();
+    }
   }
 }
 
@@ -490,9 +553,35 @@ void InputSection<E>::apply_reloc_alloc(Context<E> &ctx, u8 *base) {
 template <>
 void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
   std::span<ElfRel<E>> rels = get_rels(ctx);
+  i64 num_fast = 0;
 
   for (i64 i = 0; i < rels.size(); i++) {
     const ElfRel<E> &rel = rels[i];
+
+    // Most relocations in debug info sections are R_X86_64_32 or
+    // R_X86_64_64 against section symbols. Handle them first without
+    // looking up symbols or fragments. Relocations tend to refer
+    // symbols in random order, so we prefetch symbol addresses.
+    if (i + 16 < rels.size())
+      __builtin_prefetch(&file.symbol_addrs[rels[i + 16].r_sym]);
+
+    if ((rel.r_type == R_X86_64_64 || rel.r_type == R_X86_64_32) &&
+        !file.slow_reloc_syms[rel.r_sym]) {
+      u64 val = file.symbol_addrs[rel.r_sym] + rel.r_addend;
+      if (rel.r_type == R_X86_64_64) {
+        *(u64 *)(base + rel.r_offset) = val;
+        num_fast++;
+        continue;
+      }
+
+      // If it overflows, the code below reports an error.
+      if (val == (u32)val) {
+        *(u32 *)(base + rel.r_offset) = val;
+        num_fast++;
+        continue;
+      }
+    }
+
     if (rel.r_type == R_X86_64_NONE)
       continue;
 
@@ -535,7 +624,7 @@ void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
       *(u32 *)loc = val;
     };
 
-#define S (frag ? frag->get_addr(ctx) : sym.get_addr(ctx))
+#define S (frag ? frag->get_addr(ctx) : file.symbol_addrs[rel.r_sym])
 #define A (frag ? addend : rel.r_addend)
 
     switch (rel.r_type) {
@@ -575,6 +664,9 @@ void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
 #undef S
 #undef A
   }
+
+  static Counter counter("reloc_nonalloc_fast");
+  counter += num_fast;
 }
 
 // Linker has to create data structures in an output file to apply
@@ -582,12 +674,54 @@ void InputSection<E>::apply_reloc_nonalloc(Context<E> &ctx, u8 *base) {
 // or a PLT entry of a symbol, linker has to create an entry in .got
 // or in .plt for that symbol. In order to fix the file layout, we
 // need to scan relocations.
+// Returns a RelocOp kind for a relocation that doesn't need a dynamic
+// relocation.
+static u8 get_reloc_op_kind(u32 r_type) {
+  switch (r_type) {
+  case R_X86_64_32:
+    return RelocOp::ABS32;
+  case R_X86_64_32S:
+    return RelocOp::ABS32S;
+  case R_X86_64_64:
+    return RelocOp::ABS64;
+  case R_X86_64_PC32:
+  case R_X86_64_PLT32:
+    return RelocOp::PC32;
+  case R_X86_64_PC64:
+    return RelocOp::PC64;
+  }
+  return RelocOp::GENERIC;
+}
+
 template <>
 void InputSection<E>::scan_relocations(Context<E> &ctx) {
   assert(shdr.sh_flags & SHF_ALLOC);
 
   this->reldyn_offset = file.num_dynrel * sizeof(ElfRel<E>);
   std::span<ElfRel<E>> rels = get_rels(ctx);
+  i64 frag_idx = 0;
+
+  reloc_plan.clear();
+  reloc_plan.reserve(rels.size());
+
+  auto add_reloc_op = [&](i64 i, const SectionFragmentRef<E> *frag_ref,
+                          u8 kind) {
+    const ElfRel<E> &rel = rels[i];
+    i64 frag_idx = frag_ref ? frag_ref - rel_fragments.get() : -1;
+    i64 addend = frag_ref ? frag_ref->addend : rel.r_addend;
+
+    // Addends are almost always small. If not, we fall back to the
+    // generic code.
+    if (kind == RelocOp::GENERIC || addend != (i32)addend)
+      reloc_plan.push_back({(u32)rel.r_offset, (u32)i, (i32)frag_idx,
+                            RelocOp::GENERIC, false});
+    else if (frag_ref)
+      reloc_plan.push_back({(u32)rel.r_offset, (u32)frag_idx, (i32)addend,
+                            kind, true});
+    else
+      reloc_plan.push_back({(u32)rel.r_offset, rel.r_sym, (i32)addend,
+                            kind, false});
+  };
 
   // Scan relocations
   for (i64 i = 0; i < rels.size(); i++) {
@@ -598,8 +732,13 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
     Symbol<E> &sym = *file.symbols[rel.r_sym];
     u8 *loc = (u8 *)(contents.data() + rel.r_offset);
 
+    const SectionFragmentRef<E> *frag_ref = nullptr;
+    if (rel_fragments && rel_fragments[frag_idx].idx == i)
+      frag_ref = &rel_fragments[frag_idx++];
+
     if (!sym.file) {
       report_undef(ctx, sym);
+      add_reloc_op(i, frag_ref, RelocOp::GENERIC);
       continue;
     }
 
@@ -697,20 +836,24 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
         Fatal(ctx) << *this
                    << ": TLSGD reloc must be followed by PLT32 or GOTPCREL";
 
-      if (ctx.arg.relax && !ctx.arg.shared && !sym.is_imported)
-        i++;
-      else
-        sym.flags |= NEEDS_TLSGD;
+      if (ctx.arg.relax && !ctx.arg.shared && !sym.is_imported) {
+        // The following relocation is for a call to __tls_get_addr,
+        // which is rewritten by relaxation.
+        add_reloc_op(i++, frag_ref, RelocOp::GENERIC);
+        continue;
+      }
+      sym.flags |= NEEDS_TLSGD;
       break;
     case R_X86_64_TLSLD:
       if (i + 1 == rels.size())
         Fatal(ctx) << *this
                    << ": TLSLD reloc must be followed by PLT32 or GOTPCREL";
 
-      if (ctx.arg.relax && !ctx.arg.shared)
-        i++;
-      else
-        sym.flags |= NEEDS_TLSLD;
+      if (ctx.arg.relax && !ctx.arg.shared) {
+        add_reloc_op(i++, frag_ref, RelocOp::GENERIC);
+        continue;
+      }
+      sym.flags |= NEEDS_TLSLD;
       break;
     case R_X86_64_GOTTPOFF: {
       ctx.has_gottp_rel = true;
@@ -743,6 +886,27 @@ void InputSection<E>::scan_relocations(Context<E> &ctx) {
     default:
       Error(ctx) << *this << ": unknown relocation: " << rel;
     }
+
+    // Compile the relocation to an operation that apply_reloc_alloc()
+    // can execute without looking at the relocation again.
+    if (needs_dynrel[i])
+      add_reloc_op(i, frag_ref, ctx.arg.pack_dyn_relocs_android ?
+                   RelocOp::DYNREL_ANDROID : RelocOp::DYNREL);
+    else if (needs_baserel[i])
+      add_reloc_op(i, frag_ref, is_relr_reloc(ctx, rel) ?
+                   RelocOp::BASEREL_RELR : RelocOp::BASEREL);
+    else
+      add_reloc_op(i, frag_ref, get_reloc_op_kind(rel.r_type));
+  }
+
+  if (Counter::enabled) {
+    static Counter num_ops("reloc_plan_ops");
+    static Counter num_generic("reloc_plan_generic");
+
+    num_ops += reloc_plan.size();
+    for (const RelocOp &op : reloc_plan)
+      if (op.kind == RelocOp::GENERIC)
+        num_generic++;
   }
 }
 
@@ -0,0 +1,310 @@
+// This file implements function ordering based on call graph profiles.
+//
+// If a program is compiled with Clang's profile-guided optimization,
+// each object file contains a .llvm.call-graph-profile section which
+// records how many times each function called other functions. We use
+// that information to place functions that call each other frequently
+// next to each other to improve i-cache and i-TLB utilization.
+//
+// The algorithm is C3 described in "Optimizing Function Placement for
+// Large-Scale Data-Center Applications" by Ottoni and Maher (CGO 2017),
+// which is also what lld uses. Each input section starts as its own
+// cluster. We visit clusters in decreasing order of density (the
+// number of samples per byte) and append each cluster to the cluster
+// containing its most likely caller, unless doing so makes the result
+// too large or too sparse. Clusters are then laid out in decreasing
+// order of density.
+
+#include "mold.h"
+
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_for_each.h>
+#include <tbb/parallel_sort.h>
+
+namespace mold::elf {
+
+static constexpr i64 MAX_CLUSTER_SIZE = 1024 * 1024;
+static constexpr double MAX_DENSITY_DEGRADATION = 8.0;
+
+// Sections are identified by InputSection::get_priority() values,
+// which are unique and don't depend on memory layout.
+template <typename E>
+struct CallEdge {
+  u64 from_key;
+  u64 to_key;
+  InputSection<E> *from;
+  InputSection<E> *to;
+  u64 weight;
+};
+
+struct Cluster {
+  double get_density() const {
+    return size ? (double)weight / size : 0;
+  }
+
+  i32 next;
+  i32 prev;
+  u64 size;
+  u64 weight = 0;
+  u64 initial_weight = 0;
+  i32 best_pred = -1;
+  u64 best_pred_weight = 0;
+};
+
+template <typename E>
+static std::vector<CallEdge<E>>
+read_call_graph_profile(Context<E> &ctx, ObjectFile<E> &file) {
+  std::vector<CallEdge<E>> vec;
+
+  auto get_section = [&](i64 symidx) -> InputSection<E> * {
+    if (symidx >= file.symbols.size())
+      Fatal(ctx) << file << ": .llvm.call-graph-profile: "
+                 << "invalid symbol index: " << symidx;
+
+    Symbol<E> &sym = *file.symbols[symidx];
+    InputSection<E> *isec = sym.file ? sym.input_section : nullptr;
+    if (isec && isec->is_alive && (isec->shdr.sh_flags & SHF_EXECINSTR))
+      return isec;
+    return nullptr;
+  };
+
+  auto add = [&](i64 from, i64 to, u64 weight) {
+    InputSection<E> *x = get_section(from);
+    InputSection<E> *y = get_section(to);
+    if (x && y && weight && x->output_section == y->output_section)
+      vec.push_back({(u64)x->get_priority(), (u64)y->get_priority(), x, y,
+                     weight});
+  };
+
+  const ElfShdr<E> &shdr = *file.llvm_cgprofile;
+
+  if (file.llvm_cgprofile_rels) {
+    // Each entry consists of a 64-bit weight and a pair of relocations
+    // referring to the caller and the callee.
+    std::span<u64> weights = file.template get_data<u64>(ctx, shdr);
+    std::span<ElfRel<E>> rels =
+      file.template get_data<ElfRel<E>>(ctx, *file.llvm_cgprofile_rels);
+
+    if (rels.size() != weights.size() * 2)
+      Fatal(ctx) << file << ": .llvm.call-graph-profile: "
+                 << "the number of relocations doesn't match";
+
+    for (i64 i = 0; i < weights.size(); i++)
+      add(rels[i * 2].r_sym, rels[i * 2 + 1].r_sym, weights[i]);
+  } else if (shdr.sh_entsize == 16) {
+    // Old format which refers to symbols by symbol indices.
+    struct Entry {
+      u32 from;
+      u32 to;
+      u64 weight;
+    };
+
+    for (Entry &ent : file.template get_data<Entry>(ctx, shdr))
+      add(ent.from, ent.to, ent.weight);
+  }
+  return vec;
+}
+
+template <typename E>
+void sort_by_call_graph_profile(Context<E> &ctx) {
+  Timer t(ctx, "sort_by_call_graph_profile");
+
+  // Read call graph edges.
+  std::vector<std::vector<CallEdge<E>>> vec(ctx.objs.size());
+
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    if (ctx.objs[i]->llvm_cgprofile)
+      vec[i] = read_call_graph_profile(ctx, *ctx.objs[i]);
+  });
+
+  std::vector<CallEdge<E>> edges = flatten(vec);
+  if (edges.empty())
+    return;
+
+  static Counter counter("call_graph_edges");
+  counter += edges.size();
+
+  // Merge duplicate edges. Sorting by section keys also makes the
+  // output deterministic.
+  tbb::parallel_sort(edges.begin(), edges.end(),
+                     [](const CallEdge<E> &a, const CallEdge<E> &b) {
+    return std::tuple(a.from_key, a.to_key) < std::tuple(b.from_key, b.to_key);
+  });
+
+  i64 num_edges = 0;
+  for (CallEdge<E> &e : edges) {
+    if (num_edges && edges[num_edges - 1].from == e.from &&
+        edges[num_edges - 1].to == e.to)
+      edges[num_edges - 1].weight += e.weight;
+    else
+      edges[num_edges++] = e;
+  }
+  edges.resize(num_edges);
+
+  // Create a node for each section.
+  std::vector<std::pair<u64, InputSection<E> *>> keys;
+  keys.reserve(edges.size() * 2);
+  for (CallEdge<E> &e : edges) {
+    keys.push_back({e.from_key, e.from});
+    keys.push_back({e.to_key, e.to});
+  }
+
+  tbb::parallel_sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  std::vector<u64> node_keys(keys.size());
+  std::vector<InputSection<E> *> sections(keys.size());
+  for (i64 i = 0; i < keys.size(); i++)
+    std::tie(node_keys[i], sections[i]) = keys[i];
+
+  auto get_node = [&](u64 key) {
+    return std::lower_bound(node_keys.begin(), node_keys.end(), key) -
+           node_keys.begin();
+  };
+
+  std::vector<std::pair<i32, i32>> nodes(edges.size());
+  tbb::parallel_for((i64)0, (i64)edges.size(), [&](i64 i) {
+    nodes[i] = {get_node(edges[i].from_key), get_node(edges[i].to_key)};
+  });
+
+  std::vector<Cluster> clusters(sections.size());
+  for (i64 i = 0; i < sections.size(); i++) {
+    clusters[i].next = i;
+    clusters[i].prev = i;
+    clusters[i].size = sections[i]->shdr.sh_size;
+  }
+
+  std::vector<i32> leaders(clusters.size());
+  for (i64 i = 0; i < leaders.size(); i++)
+    leaders[i] = i;
+
+  // Both ends of an edge belong to the same output section, and we
+  // never move a section to another output section. So clusters in
+  // different output sections are independent of each other, and we
+  // can run the algorithm for each output section in parallel.
+  //
+  // Each group lists its nodes and edges in ascending order, so the
+  // result is the same as if we processed all nodes in one loop.
+  struct Group {
+    std::vector<i32> nodes;
+    std::vector<i32> edges;
+    std::vector<i32> sorted;
+  };
+
+  std::vector<Group> groups;
+  std::unordered_map<OutputSection<E> *, i64> group_idx;
+  std::vector<i32> node_group(sections.size());
+
+  for (i64 i = 0; i < sections.size(); i++) {
+    auto [it, inserted] =
+      group_idx.insert({sections[i]->output_section, groups.size()});
+    if (inserted)
+      groups.emplace_back();
+    node_group[i] = it->second;
+    groups[it->second].nodes.push_back(i);
+  }
+
+  for (i64 i = 0; i < edges.size(); i++)
+    groups[node_group[nodes[i].second]].edges.push_back(i);
+
+  auto get_leader = [&](i32 v) {
+    while (leaders[v] != v) {
+      leaders[v] = leaders[leaders[v]];
+      v = leaders[v];
+    }
+    return v;
+  };
+
+  tbb::parallel_for_each(groups, [&](Group &group) {
+    // Compute the weight of each node and its most likely caller.
+    for (i32 i : group.edges) {
+      auto [from, to] = nodes[i];
+      u64 weight = edges[i].weight;
+      Cluster &c = clusters[to];
+
+      c.weight += weight;
+      if (from != to && (c.best_pred == -1 || c.best_pred_weight < weight)) {
+        c.best_pred = from;
+        c.best_pred_weight = weight;
+      }
+    }
+
+    for (i32 i : group.nodes)
+      clusters[i].initial_weight = clusters[i].weight;
+
+    // Merge clusters.
+    std::vector<i32> sorted = group.nodes;
+    sort(sorted, [&](i32 a, i32 b) {
+      return clusters[a].get_density() > clusters[b].get_density();
+    });
+
+    for (i32 idx : sorted) {
+      Cluster &c = clusters[idx];
+
+      // Don't merge if the caller is unlikely.
+      if (c.best_pred == -1 || c.best_pred_weight * 10 <= c.initial_weight)
+        continue;
+
+      i32 pred_idx = get_leader(c.best_pred);
+      if (pred_idx == idx)
+        continue;
+
+      Cluster &pred = clusters[pred_idx];
+      if (c.size + pred.size > MAX_CLUSTER_SIZE)
+        continue;
+
+      double density = (double)(pred.weight + c.weight) / (pred.size + c.size);
+      if (density < pred.get_density() / MAX_DENSITY_DEGRADATION)
+        continue;
+
+      // Append `c` to `pred`.
+      leaders[idx] = pred_idx;
+
+      i32 tail1 = pred.prev;
+      i32 tail2 = c.prev;
+      pred.prev = tail2;
+      clusters[tail2].next = pred_idx;
+      c.prev = tail1;
+      clusters[tail1].next = idx;
+
+      pred.size += c.size;
+      pred.weight += c.weight;
+      c.size = 0;
+      c.weight = 0;
+    }
+
+    // Sort the remaining clusters by density.
+    std::erase_if(sorted, [&](i32 i) { return leaders[i] != i; });
+    std::sort(sorted.begin(), sorted.end());
+    sort(sorted, [&](i32 a, i32 b) {
+      return clusters[a].get_density() > clusters[b].get_density();
+    });
+    group.sorted = std::move(sorted);
+  });
+
+  // Lay out clusters. Member order matters only within each output
+  // section, so we can simply concatenate groups.
+  std::unordered_map<InputSection<E> *, i64> order;
+  order.reserve(sections.size());
+
+  for (Group &group : groups) {
+    for (i32 leader : group.sorted) {
+      i32 i = leader;
+      do {
+        order.insert({sections[i], order.size()});
+        i = clusters[i].next;
+      } while (i != leader);
+    }
+  }
+
+  sort_output_section_members(ctx, order);
+}
+
+#define INSTANTIATE(E)                                          \
+  template void sort_by_call_graph_profile(Context<E> &ctx);
+
+INSTANTIATE(X86_64);
+INSTANTIATE(I386);
+INSTANTIATE(ARM64);
+
+} // namespace mold::elf
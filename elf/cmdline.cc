@@ -27,7 +27,7 @@ Options:
   -M, --print-map             Write map file to stdout
   -N, --omagic                Do not page align data, do not make text readonly
     --no-omagic
-  -O NUMBER                   Ignored
+  -O NUMBER                   Set optimization level
   -S, --strip-debug           Strip .debug_* sections
   -T FILE, --script FILE      Read linker script
   -X, --discard-locals        Discard temporary local symbols
@@ -48,12 +48,17 @@ Options:
   --Bsymbolic-functions       Bind global functions locally
   --Bno-symbolic              Cancel --Bsymbolic and --Bsymbolic-functions
   --Map FILE                  Write map file to a given file
+  --Map-format [text,json,csv]
+                              Set map file format (default: text)
   --allow-multiple-definition Allow multiple definitions
   --as-needed                 Only set DT_NEEDED if used
     --no-as-needed
   --build-id [none,md5,sha1,sha256,uuid,HEXSTRING]
                               Generate build ID
     --no-build-id
+  --call-graph-profile-sort   Lay out functions using .llvm.call-graph-profile
+                              sections (default)
+    --no-call-graph-profile-sort
   --chroot DIR                Set a given path to root directory
   --color-diagnostics=[auto,always,never]
                               Use colors in diagnostics
@@ -81,18 +86,20 @@ Options:
   --gdb-index                 Ignored
   --hash-style [sysv,gnu,both]
                               Set hash style
-  --icf                       Fold identical code
+  --huge-pages                Use transparent huge pages for large buffers
+    --no-huge-pages
+  --icf [all,safe,none]       Fold identical code
     --no-icf
   --image-base ADDR           Set the base address to a given value
   --init SYMBOL               Call SYMBOl at load-time
   --no-undefined              Report undefined symbols (even with --shared)
-  --pack-dyn-relocs=[relr,none]
+  --pack-dyn-relocs=[relr,android,android+relr,none]
                               Pack dynamic relocations
   --perf                      Print performance statistics
   --pie, --pic-executable     Create a position independent executable
     --no-pie, --no-pic-executable
-  --plugin                    Ignored
-  --plugin-opt                Ignored
+  --plugin PLUGIN             Load a given linker plugin for LTO
+  --plugin-opt OPTION         Pass an option to the linker plugin
   --pop-state                 Pop state of flags governing input file handling
   --preload
     --no-preload
@@ -108,6 +115,8 @@ Options:
   --repro                     Embed input files to .repro section
   --require-defined SYMBOL    Require SYMBOL be defined in the final output
   --retain-symbols-file FILE  Keep only symbols listed in FILE
+  --reuse-output              Rewrite only changed pages of an existing output file
+    --no-reuse-output
   --rpath DIR                 Add DIR to runtime search path
   --rpath-link DIR            Ignored
   --run COMMAND ARG...        Run COMMAND with mold as /usr/bin/ld
@@ -119,6 +128,7 @@ Options:
     --end-lib                 End the effect of --start-lib
   --static                    Do not link against shared libraries
   --stats                     Print input statistics
+  --symbol-ordering-file FILE Lay out sections in the order of symbols in FILE
   --sysroot DIR               Set target system root directory
   --thread-count COUNT, --threads=COUNT
                               Use COUNT number of threads
@@ -131,6 +141,9 @@ Options:
   --version-script FILE       Read version script
   --warn-common               Warn about common symbols
     --no-warn-common
+  --warn-symbol-ordering      Warn about symbols in --symbol-ordering-file that
+                              cannot be ordered (default)
+    --no-warn-symbol-ordering
   --warn-unresolved-symbols   Report unresolved symbols as warnings
     --error-unresolved-symbols
                               Report unresolved symbols as errors (default)
@@ -390,6 +403,32 @@ static void read_retain_symbols_file(Context<E> &ctx, std::string_view path) {
   }
 }
 
+template <typename E>
+static void read_symbol_ordering_file(Context<E> &ctx, std::string_view path) {
+  MappedFile<Context<E>> *mf =
+    MappedFile<Context<E>>::must_open(ctx, std::string(path));
+  std::string_view data((char *)mf->data, mf->size);
+
+  ctx.arg.symbol_ordering_file.clear();
+
+  while (!data.empty()) {
+    size_t pos = data.find('\n');
+    std::string_view name;
+
+    if (pos == data.npos) {
+      name = data;
+      data = "";
+    } else {
+      name = data.substr(0, pos);
+      data = data.substr(pos + 1);
+    }
+
+    name = trim(name.substr(0, name.find('#')));
+    if (!name.empty())
+      ctx.arg.symbol_ordering_file.push_back(name);
+  }
+}
+
 static bool is_file(std::string_view path) {
   struct stat st;
   return stat(std::string(path).c_str(), &st) == 0 &&
@@ -479,6 +518,15 @@ void parse_nonpositional_args(Context<E> &ctx,
     } else if (read_arg(ctx, args, arg, "e") ||
                read_arg(ctx, args, arg, "entry")) {
       ctx.arg.entry = arg;
+    } else if (read_arg(ctx, args, arg, "Map-format")) {
+      if (arg == "text")
+        ctx.arg.Map_format = MAP_TEXT;
+      else if (arg == "json")
+        ctx.arg.Map_format = MAP_JSON;
+      else if (arg == "csv")
+        ctx.arg.Map_format = MAP_CSV;
+      else
+        Fatal(ctx) << "unknown --Map-format argument: " << arg;
     } else if (read_arg(ctx, args, arg, "Map")) {
       ctx.arg.Map = arg;
       ctx.arg.print_map = true;
@@ -515,6 +563,8 @@ void parse_nonpositional_args(Context<E> &ctx,
     } else if (read_arg(ctx, args, arg, "L") ||
                read_arg(ctx, args, arg, "library-path")) {
       ctx.arg.library_paths.push_back(std::string(arg));
+    } else if (read_arg(ctx, args, arg, "symbol-ordering-file")) {
+      read_symbol_ordering_file(ctx, arg);
     } else if (read_arg(ctx, args, arg, "sysroot")) {
       ctx.arg.sysroot = arg;
     } else if (read_arg(ctx, args, arg, "unique")) {
@@ -551,6 +601,10 @@ void parse_nonpositional_args(Context<E> &ctx,
       } else {
         Fatal(ctx) << "invalid --hash-style argument: " << arg;
       }
+    } else if (read_flag(args, "huge-pages")) {
+      ctx.arg.huge_pages = true;
+    } else if (read_flag(args, "no-huge-pages")) {
+      ctx.arg.huge_pages = false;
     } else if (read_arg(ctx, args, arg, "soname") ||
                read_arg(ctx, args, arg, "h")) {
       ctx.arg.soname = arg;
@@ -577,9 +631,18 @@ void parse_nonpositional_args(Context<E> &ctx,
       ctx.arg.relocatable = true;
     } else if (read_flag(args, "perf")) {
       ctx.arg.perf = true;
+      TimerRecord::count_dtlb_misses = true;
     } else if (read_flag(args, "pack-dyn-relocs=relr")) {
+      ctx.arg.pack_dyn_relocs_android = false;
+      ctx.arg.pack_dyn_relocs_relr = true;
+    } else if (read_flag(args, "pack-dyn-relocs=android")) {
+      ctx.arg.pack_dyn_relocs_android = true;
+      ctx.arg.pack_dyn_relocs_relr = false;
+    } else if (read_flag(args, "pack-dyn-relocs=android+relr")) {
+      ctx.arg.pack_dyn_relocs_android = true;
       ctx.arg.pack_dyn_relocs_relr = true;
     } else if (read_flag(args, "pack-dyn-relocs=none")) {
+      ctx.arg.pack_dyn_relocs_android = false;
       ctx.arg.pack_dyn_relocs_relr = false;
     } else if (read_flag(args, "stats")) {
       ctx.arg.stats = true;
@@ -607,6 +670,14 @@ void parse_nonpositional_args(Context<E> &ctx,
       ctx.arg.warn_common = true;
     } else if (read_flag(args, "no-warn-common")) {
       ctx.arg.warn_common = false;
+    } else if (read_flag(args, "warn-symbol-ordering")) {
+      ctx.arg.warn_symbol_ordering = true;
+    } else if (read_flag(args, "no-warn-symbol-ordering")) {
+      ctx.arg.warn_symbol_ordering = false;
+    } else if (read_flag(args, "call-graph-profile-sort")) {
+      ctx.arg.call_graph_profile_sort = true;
+    } else if (read_flag(args, "no-call-graph-profile-sort")) {
+      ctx.arg.call_graph_profile_sort = false;
     } else if (read_arg(ctx, args, arg, "compress-debug-sections")) {
       if (arg == "zlib" || arg == "zlib-gabi")
         ctx.arg.compress_debug_sections = COMPRESS_GABI;
@@ -711,12 +782,17 @@ void parse_nonpositional_args(Context<E> &ctx,
     } else if (read_flag(args, "no-print-gc-sections")) {
       ctx.arg.print_gc_sections = false;
     } else if (read_arg(ctx, args, arg, "icf")) {
-      if (arg == "all")
+      if (arg == "all") {
         ctx.arg.icf = true;
-      else if (arg == "none")
+        ctx.arg.icf_all = true;
+      } else if (arg == "safe") {
+        ctx.arg.icf = true;
+        ctx.arg.icf_all = false;
+      } else if (arg == "none") {
         ctx.arg.icf = false;
-      else
+      } else {
         Fatal(ctx) << "unknown --icf argument: " << arg;
+      }
     } else if (read_flag(args, "no-icf")) {
       ctx.arg.icf = false;
     } else if (read_arg(ctx, args, arg, "image-base")) {
@@ -729,6 +805,10 @@ void parse_nonpositional_args(Context<E> &ctx,
       ctx.arg.quick_exit = true;
     } else if (read_flag(args, "no-quick-exit")) {
       ctx.arg.quick_exit = false;
+    } else if (read_flag(args, "reuse-output")) {
+      ctx.arg.reuse_output = true;
+    } else if (read_flag(args, "no-reuse-output")) {
+      ctx.arg.reuse_output = false;
     } else if (read_arg(ctx, args, arg, "thread-count")) {
       ctx.arg.thread_count = parse_number(ctx, "thread-count", arg);
     } else if (read_flag(args, "threads")) {
@@ -798,6 +878,8 @@ void parse_nonpositional_args(Context<E> &ctx,
           " file into an object file, use `objcopy -I binary -O elf64-x86-64"
           << " <input-file> <output-file.o>` instead.";
       Fatal(ctx) << "unknown command line option: -b " << arg;
+    } else if (read_flag(args, "flto")) {
+      // GCC passes -flto to the linker. Don't mistake it for -f.
     } else if (read_arg(ctx, args, arg, "auxiliary") ||
                read_arg(ctx, args, arg, "f")) {
       ctx.arg.auxiliary.push_back(arg);
@@ -810,12 +892,18 @@ void parse_nonpositional_args(Context<E> &ctx,
       ctx.arg.preload = false;
     } else if (read_flag(args, "apply-dynamic-relocs")) {
     } else if (read_arg(ctx, args, arg, "O")) {
+      ctx.arg.optimize = parse_number(ctx, "O", arg);
     } else if (read_flag(args, "O0")) {
+      ctx.arg.optimize = 0;
     } else if (read_flag(args, "O1")) {
+      ctx.arg.optimize = 1;
     } else if (read_flag(args, "O2")) {
+      ctx.arg.optimize = 2;
     } else if (read_flag(args, "verbose")) {
     } else if (read_arg(ctx, args, arg, "plugin")) {
+      ctx.arg.plugin = arg;
     } else if (read_arg(ctx, args, arg, "plugin-opt")) {
+      ctx.arg.plugin_opt.push_back(arg);
     } else if (read_flag(args, "color-diagnostics")) {
     } else if (read_flag(args, "gdb-index")) {
     } else if (read_flag(args, "eh-frame-hdr")) {
@@ -830,7 +918,6 @@ void parse_nonpositional_args(Context<E> &ctx,
     } else if (read_flag(args, "allow-shlib-undefined")) {
     } else if (read_flag(args, "no-allow-shlib-undefined")) {
     } else if (read_flag(args, "no-add-needed")) {
-    } else if (read_flag(args, "no-call-graph-profile-sort")) {
     } else if (read_flag(args, "no-copy-dt-needed-entries")) {
     } else if (read_flag(args, "no-undefined-version")) {
     } else if (read_arg(ctx, args, arg, "sort-section")) {
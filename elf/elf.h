@@ -64,6 +64,10 @@ static constexpr u32 SHT_PREINIT_ARRAY = 16;
 static constexpr u32 SHT_GROUP = 17;
 static constexpr u32 SHT_SYMTAB_SHNDX = 18;
 static constexpr u32 SHT_RELR = 19;
+static constexpr u32 SHT_ANDROID_REL = 0x60000001;
+static constexpr u32 SHT_ANDROID_RELA = 0x60000002;
+static constexpr u32 SHT_LLVM_ADDRSIG = 0x6fff4c03;
+static constexpr u32 SHT_LLVM_CALL_GRAPH_PROFILE = 0x6fff4c09;
 static constexpr u32 SHT_GNU_HASH = 0x6ffffff6;
 static constexpr u32 SHT_GNU_VERDEF = 0x6ffffffd;
 static constexpr u32 SHT_GNU_VERNEED = 0x6ffffffe;
@@ -186,6 +190,10 @@ static constexpr u32 DT_INIT_ARRAYSZ = 27;
 static constexpr u32 DT_FINI_ARRAYSZ = 28;
 static constexpr u32 DT_RUNPATH = 29;
 static constexpr u32 DT_FLAGS = 30;
+static constexpr u32 DT_ANDROID_REL = 0x6000000f;
+static constexpr u32 DT_ANDROID_RELSZ = 0x60000010;
+static constexpr u32 DT_ANDROID_RELA = 0x60000011;
+static constexpr u32 DT_ANDROID_RELASZ = 0x60000012;
 static constexpr u32 DT_GNU_HASH = 0x6ffffef5;
 static constexpr u32 DT_VERSYM = 0x6ffffff0;
 static constexpr u32 DT_RELACOUNT = 0x6ffffff9;
@@ -861,6 +869,7 @@ struct X86_64 {
   using WordTy = u64;
 
   static constexpr u32 R_NONE = R_X86_64_NONE;
+  static constexpr u32 R_ABS = R_X86_64_64;
   static constexpr u32 R_COPY = R_X86_64_COPY;
   static constexpr u32 R_GLOB_DAT = R_X86_64_GLOB_DAT;
   static constexpr u32 R_JUMP_SLOT = R_X86_64_JUMP_SLOT;
@@ -891,6 +900,7 @@ struct I386 {
   using WordTy = u32;
 
   static constexpr u32 R_NONE = R_386_NONE;
+  static constexpr u32 R_ABS = R_386_32;
   static constexpr u32 R_COPY = R_386_COPY;
   static constexpr u32 R_GLOB_DAT = R_386_GLOB_DAT;
   static constexpr u32 R_JUMP_SLOT = R_386_JUMP_SLOT;
@@ -921,6 +931,7 @@ struct ARM64 {
   using WordTy = u64;
 
   static constexpr u32 R_NONE = R_AARCH64_NONE;
+  static constexpr u32 R_ABS = R_AARCH64_ABS64;
   static constexpr u32 R_COPY = R_AARCH64_COPY;
   static constexpr u32 R_GLOB_DAT = R_AARCH64_GLOB_DAT;
   static constexpr u32 R_JUMP_SLOT = R_AARCH64_JUMP_SLOT;
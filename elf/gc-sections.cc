@@ -90,7 +90,7 @@ collect_root_set(Context<E> &ctx) {
 
   // Add sections that are not subject to garbage collection.
   tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
-    for (std::unique_ptr<InputSection<E>> &isec : file->sections) {
+    for (InputSection<E> *isec : file->sections) {
       if (!isec || !isec->is_alive)
         continue;
 
@@ -103,7 +103,7 @@ collect_root_set(Context<E> &ctx) {
 
       if (is_init_fini(*isec) || is_c_identifier(isec->name()) ||
           isec->shdr.sh_type == SHT_NOTE)
-        enqueue_section(isec.get());
+        enqueue_section(isec);
     }
   });
 
@@ -154,7 +154,7 @@ static void sweep(Context<E> &ctx) {
   static Counter counter("garbage_sections");
 
   tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
-    for (std::unique_ptr<InputSection<E>> &isec : file->sections) {
+    for (InputSection<E> *isec : file->sections) {
       if (isec && isec->is_alive && !isec->is_visited) {
         if (ctx.arg.print_gc_sections)
           SyncOut(ctx) << "removing unused section " << *isec;
@@ -172,11 +172,10 @@ static void mark_nonalloc_fragments(Context<E> &ctx) {
   Timer t(ctx, "mark_nonalloc_fragments");
 
   tbb::parallel_for_each(ctx.objs, [](ObjectFile<E> *file) {
-    for (std::unique_ptr<MergeableSection<E>> &m : file->mergeable_sections)
-      if (m)
+    for (MergeableSection<E> *m : file->mergeable_sections)
+      if (m && !(m->parent->shdr.sh_flags & SHF_ALLOC))
         for (SectionFragment<E> *frag : m->fragments)
-          if (!(frag->output_section.shdr.sh_flags & SHF_ALLOC))
-            frag->is_alive.store(true, std::memory_order_relaxed);
+          frag->is_alive.store(true, std::memory_order_relaxed);
   });
 }
 
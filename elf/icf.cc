@@ -62,25 +62,10 @@
 #include <tbb/parallel_for_each.h>
 #include <tbb/parallel_sort.h>
 
-#ifdef __APPLE__
-#  define COMMON_DIGEST_FOR_OPENSSL
-#  include <CommonCrypto/CommonDigest.h>
-#else
-#  include <openssl/sha.h>
-#endif
-
 static constexpr int64_t HASH_SIZE = 16;
 
 typedef std::array<uint8_t, HASH_SIZE> Digest;
 
-namespace std {
-template<> struct hash<Digest> {
-  size_t operator()(const Digest &k) const {
-    return *(int64_t *)&k[0];
-  }
-};
-}
-
 namespace mold::elf {
 
 template <typename E>
@@ -103,8 +88,53 @@ static void uniquify_cies(Context<E> &ctx) {
   }
 }
 
+// In --icf=safe mode, we must not merge sections whose addresses the
+// program may depend on (e.g. functions whose pointers are compared).
+// Compilers record such symbols in .llvm_addrsig sections. If a file
+// doesn't have one, we conservatively assume that all of its sections
+// and all symbols it refers to are address-significant, because the
+// file may take the address of a function defined in another file.
+// Exported symbols are address-significant too, as other modules may
+// compare their addresses.
+template <typename E>
+static void mark_address_significant_sections(Context<E> &ctx) {
+  Timer t(ctx, "mark_address_significant_sections");
+
+  auto mark = [](Symbol<E> &sym) {
+    if (InputSection<E> *isec = sym.input_section)
+      isec->address_significant = true;
+  };
+
+  tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
+    if (!file->llvm_addrsig) {
+      for (InputSection<E> *isec : file->sections)
+        if (isec)
+          isec->address_significant = true;
+      for (Symbol<E> *sym : file->symbols)
+        mark(*sym);
+      return;
+    }
+
+    std::string_view data = file->get_string(ctx, *file->llvm_addrsig);
+    u8 *p = (u8 *)data.data();
+    u8 *end = p + data.size();
+
+    while (p < end) {
+      u64 idx = read_uleb(p);
+      if (idx >= file->symbols.size())
+        Fatal(ctx) << *file << ": .llvm_addrsig: invalid symbol index: "
+                   << idx;
+      mark(*file->symbols[idx]);
+    }
+
+    for (Symbol<E> *sym : file->get_global_syms())
+      if (sym->file == file && sym->is_exported)
+        mark(*sym);
+  });
+}
+
 template <typename E>
-static bool is_eligible(InputSection<E> &isec) {
+static bool is_eligible(Context<E> &ctx, InputSection<E> &isec) {
   const ElfShdr<E> &shdr = isec.shdr;
   std::string_view name = isec.name();
 
@@ -118,21 +148,54 @@ static bool is_eligible(InputSection<E> &isec) {
   bool is_init = (shdr.sh_type == SHT_INIT_ARRAY || name == ".init");
   bool is_fini = (shdr.sh_type == SHT_FINI_ARRAY || name == ".fini");
   bool is_enumerable = is_c_identifier(name);
+  bool is_note = (shdr.sh_type == SHT_NOTE);
+  bool is_link_order = (shdr.sh_flags & SHF_LINK_ORDER);
 
-  return is_alloc && is_executable && is_readonly && !is_bss &&
-         !is_empty && !is_init && !is_fini && !is_enumerable;
-}
+  if (!is_alloc || !is_readonly || is_bss || is_empty || is_init ||
+      is_fini || is_enumerable)
+    return false;
 
-static Digest digest_final(SHA256_CTX &sha) {
-  u8 buf[SHA256_SIZE];
-  int res = SHA256_Final(buf, &sha);
-  assert(res == 1);
+  // --icf=all merges code even if its address is taken.
+  if (ctx.arg.icf_all)
+    return is_executable;
 
-  Digest digest;
-  memcpy(digest.data(), buf, HASH_SIZE);
-  return digest;
+  // --icf=safe merges only sections whose addresses don't matter,
+  // so read-only data such as vtables can be merged as well.
+  return !isec.address_significant && !is_note && !is_link_order;
 }
 
+// DigestBuilder computes a digest of a byte sequence. We use XXH3-128
+// instead of a cryptographic hash function because it is several times
+// faster. We don't rely on digests being collision-free, since we
+// compare sections byte-by-byte before folding them (see
+// verify_classes()).
+class DigestBuilder {
+public:
+  DigestBuilder(i64 size = 0) {
+    buf.reserve(size);
+  }
+
+  template <typename T>
+  void add(const T &val) {
+    add_bytes(&val, sizeof(val));
+  }
+
+  void add_bytes(const void *data, i64 size) {
+    buf.insert(buf.end(), (u8 *)data, (u8 *)data + size);
+  }
+
+  Digest finish() {
+    XXH128_hash_t hash = XXH3_128bits(buf.data(), buf.size());
+    Digest digest;
+    memcpy(digest.data(), &hash, HASH_SIZE);
+    buf.clear();
+    return digest;
+  }
+
+private:
+  std::vector<u8> buf;
+};
+
 template <typename E>
 static bool is_leaf(Context<E> &ctx, InputSection<E> &isec) {
   if (!isec.get_rels(ctx).empty())
@@ -164,7 +227,8 @@ struct LeafHasher {
 template <typename E>
 struct LeafEq {
   bool operator()(const InputSection<E> *a, const InputSection<E> *b) const {
-    if (a->contents != b->contents)
+    if (a->contents != b->contents ||
+        a->shdr.sh_addralign != b->shdr.sh_addralign)
       return false;
 
     std::span<FdeRecord<E>> x = a->get_fdes();
@@ -192,11 +256,11 @@ static void merge_leaf_nodes(Context<E> &ctx) {
                                 LeafHasher<E>, LeafEq<E>> map;
 
   tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
-    for (std::unique_ptr<InputSection<E>> &isec : ctx.objs[i]->sections) {
+    for (InputSection<E> *isec : ctx.objs[i]->sections) {
       if (!isec || !isec->is_alive)
         continue;
 
-      if (!is_eligible(*isec)) {
+      if (!is_eligible(ctx, *isec)) {
         non_eligible++;
         continue;
       }
@@ -204,9 +268,9 @@ static void merge_leaf_nodes(Context<E> &ctx) {
       if (is_leaf(ctx, *isec)) {
         leaf++;
         isec->icf_leaf = true;
-        auto [it, inserted] = map.insert({isec.get(), isec.get()});
+        auto [it, inserted] = map.insert({isec, isec});
         if (!inserted && isec->get_priority() < it->second->get_priority())
-          it->second = isec.get();
+          it->second = isec;
       } else {
         eligible++;
         isec->icf_eligible = true;
@@ -215,9 +279,9 @@ static void merge_leaf_nodes(Context<E> &ctx) {
   });
 
   tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
-    for (std::unique_ptr<InputSection<E>> &isec : ctx.objs[i]->sections) {
+    for (InputSection<E> *isec : ctx.objs[i]->sections) {
       if (isec && isec->is_alive && isec->icf_leaf) {
-        auto it = map.find(isec.get());
+        auto it = map.find(isec);
         assert(it != map.end());
         isec->leader = it->second;
       }
@@ -227,16 +291,15 @@ static void merge_leaf_nodes(Context<E> &ctx) {
 
 template <typename E>
 static Digest compute_digest(Context<E> &ctx, InputSection<E> &isec) {
-  SHA256_CTX sha;
-  SHA256_Init(&sha);
+  DigestBuilder builder(isec.contents.size() + 256);
 
   auto hash = [&](auto val) {
-    SHA256_Update(&sha, &val, sizeof(val));
+    builder.add(val);
   };
 
   auto hash_string = [&](std::string_view str) {
     hash(str.size());
-    SHA256_Update(&sha, str.data(), str.size());
+    builder.add_bytes(str.data(), str.size());
   };
 
   auto hash_symbol = [&](Symbol<E> &sym) {
@@ -264,6 +327,7 @@ static Digest compute_digest(Context<E> &ctx, InputSection<E> &isec) {
 
   hash_string(isec.contents);
   hash(isec.shdr.sh_flags);
+  hash(isec.shdr.sh_addralign);
   hash(isec.get_fdes().size());
   hash(isec.get_rels(ctx).size());
 
@@ -302,7 +366,7 @@ static Digest compute_digest(Context<E> &ctx, InputSection<E> &isec) {
     }
   }
 
-  return digest_final(sha);
+  return builder.finish();
 }
 
 template <typename E>
@@ -313,7 +377,7 @@ static std::vector<InputSection<E> *> gather_sections(Context<E> &ctx) {
   std::vector<i64> num_sections(ctx.objs.size());
 
   tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
-    for (std::unique_ptr<InputSection<E>> &isec : ctx.objs[i]->sections)
+    for (InputSection<E> *isec : ctx.objs[i]->sections)
       if (isec && isec->is_alive && isec->icf_eligible)
         num_sections[i]++;
   });
@@ -328,9 +392,9 @@ static std::vector<InputSection<E> *> gather_sections(Context<E> &ctx) {
   // Fill `sections` contents.
   tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
     i64 idx = section_indices[i];
-    for (std::unique_ptr<InputSection<E>> &isec : ctx.objs[i]->sections)
+    for (InputSection<E> *isec : ctx.objs[i]->sections)
       if (isec && isec->is_alive && isec->icf_eligible)
-        sections[idx++] = isec.get();
+        sections[idx++] = isec;
   });
 
   tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
@@ -359,6 +423,9 @@ static void gather_edges(Context<E> &ctx,
                          std::vector<u32> &edge_indices) {
   Timer t(ctx, "gather_edges");
 
+  if (sections.empty())
+    return;
+
   std::vector<i64> num_edges(sections.size());
   edge_indices.resize(sections.size());
 
@@ -393,6 +460,7 @@ static void gather_edges(Context<E> &ctx,
     for (i64 j = 0; j < isec.get_rels(ctx).size(); j++) {
       if (isec.rel_fragments && isec.rel_fragments[frag_idx].idx == j) {
         frag_idx++;
+      } else {
         ElfRel<E> &rel = isec.get_rels(ctx)[j];
         Symbol<E> &sym = *isec.file.symbols[rel.r_sym];
         if (!sym.get_frag() && sym.input_section &&
@@ -403,52 +471,253 @@ static void gather_edges(Context<E> &ctx,
   });
 }
 
+// Once we have initial digests, ICF is a partition refinement problem.
+// We start from a partition in which sections with the same digest are
+// in the same class, and split classes until all sections in each class
+// refer to the same classes in the same order.
+//
+// Members of each class are kept in a contiguous range of `order`, and
+// a class is identified by the start index of its range. In each round,
+// we revisit only classes that contain a section referring to a class
+// split in the previous round; other classes cannot be split because
+// nothing they refer to has changed. We are done when no class is split.
+//
+// Returns the class ID of each section.
 template <typename E>
-static i64 propagate(std::span<std::vector<Digest>> digests,
-                     std::span<u32> edges, std::span<u32> edge_indices,
-                     bool &slot, tbb::affinity_partitioner &ap) {
+static std::vector<u32>
+refine_classes(Context<E> &ctx, std::span<Digest> digests,
+               std::span<u32> edges, std::span<u32> edge_indices) {
+  Timer t(ctx, "propagate");
   static Counter round("icf_round");
-  round++;
+  static Counter revisited("icf_revisited_sections");
 
-  i64 num_digests = digests[0].size();
-  tbb::enumerable_thread_specific<i64> changed;
+  i64 num = digests.size();
+  auto get_edges = [&](i64 i) {
+    i64 end = (i + 1 == num) ? edges.size() : edge_indices[i + 1];
+    return edges.subspan(edge_indices[i], end - edge_indices[i]);
+  };
 
-  tbb::parallel_for((i64)0, num_digests, [&](i64 i) {
-    if (digests[slot][i] == digests[!slot][i])
-      return;
+  // Compute reverse edges.
+  std::vector<u32> redge_indices(num + 1);
+  std::vector<u32> redges(edges.size());
+
+  for (u32 j : edges)
+    redge_indices[j + 1]++;
+  for (i64 i = 0; i < num; i++)
+    redge_indices[i + 1] += redge_indices[i];
+
+  {
+    std::vector<u32> pos(redge_indices.begin(), redge_indices.end() - 1);
+    for (i64 i = 0; i < num; i++)
+      for (u32 j : get_edges(i))
+        redges[pos[j]++] = i;
+  }
+
+  // Create the initial partition.
+  std::vector<u32> order(num);
+  std::vector<u32> class_id(num);
+  std::vector<u32> class_end(num);
+
+  tbb::parallel_for((i64)0, num, [&](i64 i) { order[i] = i; });
+  tbb::parallel_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+    return std::tie(digests[a], a) < std::tie(digests[b], b);
+  });
+
+  std::vector<u32> worklist;
+
+  for (i64 begin = 0; begin < num;) {
+    i64 end = begin + 1;
+    while (end < num && digests[order[begin]] == digests[order[end]])
+      end++;
+
+    for (i64 i = begin; i < end; i++)
+      class_id[order[i]] = begin;
+    class_end[begin] = end;
+
+    if (end - begin > 1)
+      worklist.push_back(begin);
+    begin = end;
+  }
+
+  std::vector<Digest> keys(num);
+  std::vector<std::atomic_bool> is_queued(num);
+
+  while (!worklist.empty()) {
+    round++;
+
+    // Compute keys of the sections in the classes to revisit. A key
+    // of a section is a hash value of the class IDs it refers to.
+    tbb::parallel_for_each(worklist, [&](u32 begin) {
+      DigestBuilder builder;
+      for (i64 i = begin; i < class_end[begin]; i++) {
+        for (u32 j : get_edges(order[i]))
+          builder.add(class_id[j]);
+        keys[order[i]] = builder.finish();
+      }
+      revisited += class_end[begin] - begin;
+    });
+
+    // Split classes by keys.
+    tbb::concurrent_vector<u32> split;
 
-    SHA256_CTX sha;
-    SHA256_Init(&sha);
-    SHA256_Update(&sha, digests[2][i].data(), HASH_SIZE);
+    tbb::parallel_for_each(worklist, [&](u32 begin) {
+      i64 end = class_end[begin];
+      std::sort(order.begin() + begin, order.begin() + end,
+                [&](u32 a, u32 b) {
+        return std::tie(keys[a], a) < std::tie(keys[b], b);
+      });
 
-    i64 begin = edge_indices[i];
-    i64 end = (i + 1 == num_digests) ? edges.size() : edge_indices[i + 1];
+      if (keys[order[begin]] == keys[order[end - 1]])
+        return;
 
-    for (i64 j : edges.subspan(begin, end - begin))
-      SHA256_Update(&sha, digests[slot][j].data(), HASH_SIZE);
+      for (i64 i = begin; i < end;) {
+        i64 j = i + 1;
+        while (j < end && keys[order[i]] == keys[order[j]])
+          j++;
 
-    digests[!slot][i] = digest_final(sha);
+        for (i64 k = i; k < j; k++)
+          class_id[order[k]] = i;
+        class_end[i] = j;
+        i = j;
+      }
+
+      for (i64 i = begin; i < end; i++)
+        split.push_back(order[i]);
+    });
+
+    // Classes referring to members of split classes need to be
+    // revisited in the next round.
+    tbb::concurrent_vector<u32> next;
+
+    tbb::parallel_for_each(split, [&](u32 i) {
+      for (i64 k = redge_indices[i]; k < redge_indices[i + 1]; k++) {
+        u32 begin = class_id[redges[k]];
+        if (class_end[begin] - begin > 1 && !is_queued[begin].exchange(true))
+          next.push_back(begin);
+      }
+    });
 
-    if (digests[slot][i] != digests[!slot][i])
-      changed.local()++;
-  }, ap);
+    worklist.assign(next.begin(), next.end());
+    for (u32 begin : worklist)
+      is_queued[begin] = false;
+  }
 
-  slot = !slot;
-  return changed.combine(std::plus());
+  return class_id;
 }
 
+// Returns true if `a` and `b` are identical given the current
+// equivalence classes. This compares everything compute_digest() hashes.
 template <typename E>
-static i64 count_num_classes(std::span<Digest> digests,
-                             tbb::affinity_partitioner &ap) {
-  std::vector<Digest> vec(digests.begin(), digests.end());
-  tbb::parallel_sort(vec);
-
-  tbb::enumerable_thread_specific<i64> num_classes;
-  tbb::parallel_for((i64)0, (i64)vec.size() - 1, [&](i64 i) {
-    if (vec[i] != vec[i + 1])
-      num_classes.local()++;
-  }, ap);
-  return num_classes.combine(std::plus());
+static bool is_identical(Context<E> &ctx, InputSection<E> &a,
+                         InputSection<E> &b) {
+  auto sym_eq = [](Symbol<E> &x, Symbol<E> &y) {
+    if (x.value != y.value)
+      return false;
+    if (!x.file || !y.file)
+      return &x == &y;
+
+    SectionFragment<E> *frag1 = x.get_frag();
+    SectionFragment<E> *frag2 = y.get_frag();
+    if (frag1 || frag2)
+      return frag1 == frag2;
+
+    InputSection<E> *isec1 = x.input_section;
+    InputSection<E> *isec2 = y.input_section;
+    if (!isec1 || !isec2)
+      return isec1 == isec2;
+    if (isec1->leader || isec2->leader)
+      return isec1->leader == isec2->leader;
+    return isec1 == isec2;
+  };
+
+  if (a.contents != b.contents || a.shdr.sh_flags != b.shdr.sh_flags ||
+      a.shdr.sh_addralign != b.shdr.sh_addralign)
+    return false;
+
+  std::span<FdeRecord<E>> fdes1 = a.get_fdes();
+  std::span<FdeRecord<E>> fdes2 = b.get_fdes();
+  if (fdes1.size() != fdes2.size())
+    return false;
+
+  for (i64 i = 0; i < fdes1.size(); i++) {
+    FdeRecord<E> &x = fdes1[i];
+    FdeRecord<E> &y = fdes2[i];
+    if (x.cie->icf_idx != y.cie->icf_idx ||
+        x.get_contents().substr(8) != y.get_contents().substr(8) ||
+        x.get_rels().size() != y.get_rels().size())
+      return false;
+
+    for (i64 j = 1; j < x.get_rels().size(); j++) {
+      ElfRel<E> &r1 = x.get_rels()[j];
+      ElfRel<E> &r2 = y.get_rels()[j];
+      if (r1.r_type != r2.r_type ||
+          r1.r_offset - x.input_offset != r2.r_offset - y.input_offset ||
+          x.cie->input_section.get_addend(r1) !=
+          y.cie->input_section.get_addend(r2) ||
+          !sym_eq(*a.file.symbols[r1.r_sym], *b.file.symbols[r2.r_sym]))
+        return false;
+    }
+  }
+
+  std::span<ElfRel<E>> rels1 = a.get_rels(ctx);
+  std::span<ElfRel<E>> rels2 = b.get_rels(ctx);
+  if (rels1.size() != rels2.size())
+    return false;
+
+  i64 frag_idx1 = 0;
+  i64 frag_idx2 = 0;
+
+  for (i64 i = 0; i < rels1.size(); i++) {
+    ElfRel<E> &r1 = rels1[i];
+    ElfRel<E> &r2 = rels2[i];
+    if (r1.r_offset != r2.r_offset || r1.r_type != r2.r_type ||
+        a.get_addend(r1) != b.get_addend(r2))
+      return false;
+
+    bool is_frag1 = a.rel_fragments && a.rel_fragments[frag_idx1].idx == i;
+    bool is_frag2 = b.rel_fragments && b.rel_fragments[frag_idx2].idx == i;
+    if (is_frag1 != is_frag2)
+      return false;
+
+    if (is_frag1) {
+      if (a.rel_fragments[frag_idx1++].frag != b.rel_fragments[frag_idx2++].frag)
+        return false;
+    } else {
+      if (!sym_eq(*a.file.symbols[r1.r_sym], *b.file.symbols[r2.r_sym]))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Since digests are not cryptographic hashes, two different sections
+// may end up in the same class due to a hash collision, though it is
+// extremely unlikely. We compare each section with its leader and
+// remove it from the class if they are not identical. Removing a
+// section may make other sections referring to it non-identical, so
+// we repeat until no section is removed.
+template <typename E>
+static void verify_classes(Context<E> &ctx,
+                           std::span<InputSection<E> *> sections) {
+  Timer t(ctx, "verify");
+  static Counter counter("icf_hash_collisions");
+
+  for (;;) {
+    tbb::concurrent_vector<InputSection<E> *> vec;
+
+    tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
+      InputSection<E> &isec = *sections[i];
+      if (isec.leader != &isec && !is_identical(ctx, isec, *isec.leader))
+        vec.push_back(&isec);
+    });
+
+    if (vec.empty())
+      return;
+
+    for (InputSection<E> *isec : vec)
+      isec->leader = isec;
+    counter += vec.size();
+  }
 }
 
 template <typename E>
@@ -457,12 +726,12 @@ static void print_icf_sections(Context<E> &ctx) {
   tbb::concurrent_unordered_multimap<InputSection<E> *, InputSection<E> *> map;
 
   tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
-    for (std::unique_ptr<InputSection<E>> &isec : file->sections) {
+    for (InputSection<E> *isec : file->sections) {
       if (isec && isec->is_alive && isec->leader) {
-        if (isec.get() == isec->leader)
-          leaders.push_back(isec.get());
+        if (isec == isec->leader)
+          leaders.push_back(isec);
         else
-          map.insert({isec->leader, isec.get()});
+          map.insert({isec->leader, isec});
       }
     }
   });
@@ -496,72 +765,46 @@ template <typename E>
 void icf_sections(Context<E> &ctx) {
   Timer t(ctx, "icf");
 
+  if (!ctx.arg.icf_all)
+    mark_address_significant_sections(ctx);
+
   uniquify_cies(ctx);
   merge_leaf_nodes(ctx);
 
   // Prepare for the propagation rounds.
   std::vector<InputSection<E> *> sections = gather_sections(ctx);
 
-  std::vector<std::vector<Digest>> digests(3);
-  digests[0] = compute_digests<E>(ctx, sections);
-  digests[1].resize(digests[0].size());
-  digests[2] = digests[0];
+  std::vector<Digest> digests = compute_digests<E>(ctx, sections);
 
   std::vector<u32> edges;
   std::vector<u32> edge_indices;
   gather_edges<E>(ctx, sections, edges, edge_indices);
 
-  bool slot = 0;
+  std::vector<u32> class_id =
+    refine_classes<E>(ctx, digests, edges, edge_indices);
 
-  // Execute the propagation rounds until convergence is obtained.
-  {
-    Timer t(ctx, "propagate");
-    tbb::affinity_partitioner ap;
-
-    i64 num_changed = -1;
-    for (;;) {
-      i64 n = propagate<E>(digests, edges, edge_indices, slot, ap);
-      if (n == num_changed)
-        break;
-      num_changed = n;
-    }
-
-    i64 num_classes = -1;
-    for (;;) {
-      for (i64 i = 0; i < 10; i++)
-        propagate<E>(digests, edges, edge_indices, slot, ap);
-
-      i64 n = count_num_classes<E>(digests[slot], ap);
-      if (n == num_classes)
-        break;
-      num_classes = n;
-    }
-  }
-
-  // Group sections by SHA digest.
+  // Group sections by class.
   {
     Timer t(ctx, "group");
 
-    auto *map = new tbb::concurrent_unordered_map<Digest, InputSection<E> *>;
-    std::span<Digest> digest = digests[slot];
+    // Use the section with the highest priority as a class leader.
+    std::vector<std::atomic<InputSection<E> *>> leaders(sections.size());
 
     tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
-      InputSection<E> *isec = sections[i];
-      auto [it, inserted] = map->insert({digest[i], isec});
-      if (!inserted && isec->get_priority() < it->second->get_priority())
-        it->second = isec;
+      std::atomic<InputSection<E> *> &leader = leaders[class_id[i]];
+      InputSection<E> *cur = leader;
+      while (!cur || sections[i]->get_priority() < cur->get_priority())
+        if (leader.compare_exchange_weak(cur, sections[i]))
+          break;
     });
 
     tbb::parallel_for((i64)0, (i64)sections.size(), [&](i64 i) {
-      auto it = map->find(digest[i]);
-      assert(it != map->end());
-      sections[i]->leader = it->second;
+      sections[i]->leader = leaders[class_id[i]];
     });
-
-    // Since free'ing the map is slow, postpone it.
-    ctx.on_exit.push_back([=]() { delete map; });
   }
 
+  verify_classes<E>(ctx, sections);
+
   if (ctx.arg.print_icf_sections)
     print_icf_sections(ctx);
 
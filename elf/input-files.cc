@@ -141,10 +141,7 @@ ObjectFile<E>::uncompress_contents(Context<E> &ctx, const ElfShdr<E> &shdr,
   };
 
   auto copy_shdr = [&](const ElfShdr<E> &shdr) {
-    ElfShdr<E> *ret = new ElfShdr<E>;
-    ctx.shdr_pool.push_back(std::unique_ptr<ElfShdr<E>>(ret));
-    *ret = shdr;
-    return ret;
+    return shdr_arena.alloc(shdr);
   };
 
   if (name.starts_with(".zdebug")) {
@@ -185,10 +182,27 @@ ObjectFile<E>::uncompress_contents(Context<E> &ctx, const ElfShdr<E> &shdr,
 
 template <typename E>
 void ObjectFile<E>::initialize_sections(Context<E> &ctx) {
+  // Allocate all input sections of this file from a single block.
+  section_arena.reserve(this->elf_sections.size());
+
   // Read sections
   for (i64 i = 0; i < this->elf_sections.size(); i++) {
     const ElfShdr<E> &shdr = this->elf_sections[i];
 
+    // Tools that rewrite symbol tables without knowing about
+    // .llvm_addrsig (e.g. objcopy or ld -r) clear its sh_link, in which
+    // case the symbol indices in it may be stale.
+    if (shdr.sh_type == SHT_LLVM_ADDRSIG) {
+      if (shdr.sh_link != 0)
+        llvm_addrsig = &shdr;
+      continue;
+    }
+
+    if (shdr.sh_type == SHT_LLVM_CALL_GRAPH_PROFILE) {
+      llvm_cgprofile = &shdr;
+      continue;
+    }
+
     if ((shdr.sh_flags & SHF_EXCLUDE) && !(shdr.sh_flags & SHF_ALLOC))
       continue;
 
@@ -253,8 +267,7 @@ void ObjectFile<E>::initialize_sections(Context<E> &ctx) {
       std::tie(contents, shdr2) = uncompress_contents(ctx, shdr, name);
 
       this->sections[i] =
-        std::make_unique<InputSection<E>>(ctx, *this, *shdr2, name,
-                                          contents, i);
+        section_arena.alloc(ctx, *this, *shdr2, name, contents, i);
 
       static Counter counter("regular_sections");
       counter++;
@@ -273,7 +286,12 @@ void ObjectFile<E>::initialize_sections(Context<E> &ctx) {
       Fatal(ctx) << *this << ": invalid relocated section index: "
                  << (u32)shdr.sh_info;
 
-    if (std::unique_ptr<InputSection<E>> &target = sections[shdr.sh_info]) {
+    if (&this->elf_sections[shdr.sh_info] == llvm_cgprofile) {
+      llvm_cgprofile_rels = &shdr;
+      continue;
+    }
+
+    if (InputSection<E> *target = sections[shdr.sh_info]) {
       assert(target->relsec_idx == -1);
       target->relsec_idx = i;
 
@@ -289,7 +307,7 @@ void ObjectFile<E>::initialize_sections(Context<E> &ctx) {
 template <typename E>
 void ObjectFile<E>::initialize_ehframe_sections(Context<E> &ctx) {
   for (i64 i = 0; i < sections.size(); i++) {
-    std::unique_ptr<InputSection<E>> &isec = sections[i];
+    InputSection<E> *isec = sections[i];
     if (isec && isec->is_alive && isec->name() == ".eh_frame") {
       read_ehframe(ctx, *isec);
       isec->is_ehframe = true;
@@ -498,7 +516,6 @@ void ObjectFile<E>::initialize_symbols(Context<E> &ctx) {
 
     if (should_write_to_local_symtab(ctx, sym)) {
       sym.write_to_symtab = true;
-      strtab_size += sym.name().size() + 1;
       num_local_symtab++;
     }
   }
@@ -568,9 +585,8 @@ static size_t find_null(std::string_view data, u64 entsize) {
 //
 // We do not support mergeable sections that have relocations.
 template <typename E>
-static std::unique_ptr<MergeableSection<E>>
-split_section(Context<E> &ctx, InputSection<E> &sec) {
-  std::unique_ptr<MergeableSection<E>> rec(new MergeableSection<E>);
+static void split_section(Context<E> &ctx, MergeableSection<E> *rec,
+                          InputSection<E> &sec) {
   rec->parent = MergedSection<E>::get_instance(ctx, sec.name(), sec.shdr.sh_type,
                                                sec.shdr.sh_flags);
   rec->shdr = sec.shdr;
@@ -580,9 +596,8 @@ split_section(Context<E> &ctx, InputSection<E> &sec) {
   u64 entsize = sec.shdr.sh_entsize;
   HyperLogLog estimator;
 
-  static_assert(sizeof(SectionFragment<E>::alignment) == 2);
-  if (sec.shdr.sh_addralign >= UINT16_MAX)
-    Fatal(ctx) << sec << ": alignment too large";
+  if (u64 align = sec.shdr.sh_addralign; align & (align - 1))
+    Fatal(ctx) << sec << ": alignment is not a power of two";
 
   if (sec.shdr.sh_flags & SHF_STRINGS) {
     while (!data.empty()) {
@@ -604,6 +619,13 @@ split_section(Context<E> &ctx, InputSection<E> &sec) {
     if (data.size() % entsize)
       Fatal(ctx) << sec << ": section size is not multiple of sh_entsize";
 
+    rec->parent->has_non_strings = true;
+
+    i64 num_frags = data.size() / entsize;
+    rec->strings.reserve(num_frags);
+    rec->frag_offsets.reserve(num_frags);
+    rec->hashes.reserve(num_frags);
+
     while (!data.empty()) {
       std::string_view substr = data.substr(0, entsize);
       data = data.substr(entsize);
@@ -621,7 +643,6 @@ split_section(Context<E> &ctx, InputSection<E> &sec) {
 
   static Counter counter("string_fragments");
   counter += rec->fragments.size();
-  return rec;
 }
 
 // Usually a section is an atomic unit of inclusion and exclusion.
@@ -671,11 +692,12 @@ void ObjectFile<E>::initialize_mergeable_sections(Context<E> &ctx) {
   mergeable_sections.resize(sections.size());
 
   for (i64 i = 0; i < sections.size(); i++) {
-    std::unique_ptr<InputSection<E>> &isec = sections[i];
+    InputSection<E> *isec = sections[i];
     if (isec && isec->is_alive && (isec->shdr.sh_flags & SHF_MERGE) &&
         isec->shdr.sh_size && isec->shdr.sh_entsize &&
         isec->relsec_idx == -1) {
-      mergeable_sections[i] = split_section(ctx, *isec);
+      mergeable_sections[i] = mergeable_arena.alloc();
+      split_section(ctx, mergeable_sections[i], *isec);
       isec->is_alive = false;
     }
   }
@@ -683,14 +705,14 @@ void ObjectFile<E>::initialize_mergeable_sections(Context<E> &ctx) {
 
 template <typename E>
 void ObjectFile<E>::register_section_pieces(Context<E> &ctx) {
-  for (std::unique_ptr<MergeableSection<E>> &m : mergeable_sections)
+  for (MergeableSection<E> *m : mergeable_sections)
     if (m)
       for (i64 i = 0; i < m->strings.size(); i++)
         m->fragments.push_back(m->parent->insert(m->strings[i], m->hashes[i],
                                                  m->shdr.sh_addralign));
 
   // Initialize rel_fragments
-  for (std::unique_ptr<InputSection<E>> &isec : sections) {
+  for (InputSection<E> *isec : sections) {
     if (!isec || !isec->is_alive || !(isec->shdr.sh_flags & SHF_ALLOC))
       continue;
 
@@ -720,8 +742,7 @@ void ObjectFile<E>::register_section_pieces(Context<E> &ctx) {
       if (esym.st_type != STT_SECTION)
         continue;
 
-      std::unique_ptr<MergeableSection<E>> &m =
-        mergeable_sections[get_shndx(esym)];
+      MergeableSection<E> *m = mergeable_sections[get_shndx(esym)];
       if (!m)
         continue;
 
@@ -746,8 +767,7 @@ void ObjectFile<E>::register_section_pieces(Context<E> &ctx) {
     if (esym.is_abs() || esym.is_common() || esym.is_undef())
       continue;
 
-    std::unique_ptr<MergeableSection<E>> &m =
-      mergeable_sections[get_shndx(esym)];
+    MergeableSection<E> *m = mergeable_sections[get_shndx(esym)];
     if (!m)
       continue;
 
@@ -1028,7 +1048,7 @@ void ObjectFile<E>::claim_unresolved_symbols(Context<E> &ctx) {
 template <typename E>
 void ObjectFile<E>::scan_relocations(Context<E> &ctx) {
   // Scan relocations against seciton contents
-  for (std::unique_ptr<InputSection<E>> &isec : sections)
+  for (InputSection<E> *isec : sections)
     if (isec && isec->is_alive && (isec->shdr.sh_flags & SHF_ALLOC))
       isec->scan_relocations(ctx);
 
@@ -1068,22 +1088,20 @@ void ObjectFile<E>::convert_common_symbols(Context<E> &ctx) {
       continue;
     }
 
-    auto *shdr = new ElfShdr<E>;
-    ctx.shdr_pool.push_back(std::unique_ptr<ElfShdr<E>>(shdr));
-
+    ElfShdr<E> *shdr = shdr_arena.alloc();
     memset(shdr, 0, sizeof(*shdr));
     shdr->sh_flags = SHF_ALLOC;
     shdr->sh_type = SHT_NOBITS;
     shdr->sh_size = this->elf_syms[i].st_size;
     shdr->sh_addralign = this->elf_syms[i].st_value;
 
-    std::unique_ptr<InputSection<E>> isec =
-      std::make_unique<InputSection<E>>(ctx, *this, *shdr, ".common",
-                                        std::string_view(), sections.size());
+    InputSection<E> *isec =
+      section_arena.alloc(ctx, *this, *shdr, ".common", std::string_view(),
+                          sections.size());
     isec->output_section = osec;
 
     sym.file = this;
-    sym.input_section = isec.get();
+    sym.input_section = isec;
     sym.value = 0;
     sym.sym_idx = i;
     sym.ver_idx = ctx.default_version;
@@ -1091,7 +1109,7 @@ void ObjectFile<E>::convert_common_symbols(Context<E> &ctx) {
     sym.is_imported = false;
     sym.is_exported = false;
 
-    sections.push_back(std::move(isec));
+    sections.push_back(isec);
   }
 }
 
@@ -1105,10 +1123,8 @@ void ObjectFile<E>::compute_symtab(Context<E> &ctx) {
   if (ctx.arg.retain_symbols_file) {
     std::span<Symbol<E> *> syms(this->symbols);
     for (Symbol<E> *sym : syms.subspan(this->first_global)) {
-      if (sym->file == this && sym->write_to_symtab) {
-        strtab_size += sym->name().size() + 1;
+      if (sym->file == this && sym->write_to_symtab)
         num_global_symtab++;
-      }
     }
     return;
   }
@@ -1123,7 +1139,6 @@ void ObjectFile<E>::compute_symtab(Context<E> &ctx) {
       Symbol<E> &sym = *this->symbols[i];
 
       if (sym.write_to_symtab && !sym.is_alive()) {
-        strtab_size -= sym.name().size() + 1;
         num_local_symtab--;
         sym.write_to_symtab = false;
       }
@@ -1135,7 +1150,6 @@ void ObjectFile<E>::compute_symtab(Context<E> &ctx) {
     Symbol<E> &sym = *this->symbols[i];
 
     if (sym.file == this && should_write_to_global_symtab(sym)) {
-      strtab_size += sym.name().size() + 1;
       sym.write_to_symtab = true;
       num_global_symtab++;
     }
@@ -1146,15 +1160,22 @@ template <typename E>
 void ObjectFile<E>::write_symtab(Context<E> &ctx) {
   u8 *symtab_base = ctx.buf + ctx.symtab->shdr.sh_offset;
   u8 *strtab_base = ctx.buf + ctx.strtab->shdr.sh_offset;
-  i64 strtab_off = strtab_offset;
   i64 symtab_off;
+  i64 idx = 0;
 
   auto write_sym = [&](Symbol<E> &sym) {
     ElfSym<E> &esym = *(ElfSym<E> *)(symtab_base + symtab_off);
     symtab_off += sizeof(esym);
 
+    // A symbol name is written by the file that owns the string.
+    // Other files just refer to it.
+    StrtabEntry *ent = strtab_entries[idx++];
+    u32 name = ent ? ent->offset : 0;
+    if (strtab_offset <= name && name < strtab_offset + strtab_size)
+      write_string(strtab_base + name, sym.name());
+
     esym = sym.esym();
-    esym.st_name = strtab_off;
+    esym.st_name = name;
 
     if (sym.get_type() == STT_TLS)
       esym.st_value = sym.get_addr(ctx) - ctx.tls_begin;
@@ -1169,9 +1190,6 @@ void ObjectFile<E>::write_symtab(Context<E> &ctx) {
       esym.st_shndx = SHN_UNDEF;
     else
       esym.st_shndx = SHN_ABS;
-
-    write_string(strtab_base + strtab_off, sym.name());
-    strtab_off += sym.name().size() + 1;
   };
 
   symtab_off = local_symtab_offset;
@@ -30,6 +30,9 @@ InputSection<E>::InputSection(Context<E> &ctx, ObjectFile<E> &file,
                               std::string_view contents, i64 section_idx)
   : file(file), shdr(shdr), contents(contents), nameptr(name.data()),
     namelen(name.size()), section_idx(section_idx) {
+  if (u64 align = shdr.sh_addralign; align & (align - 1))
+    Fatal(ctx) << *this << ": alignment is not a power of two";
+
   output_section =
     OutputSection<E>::get_instance(ctx, name, shdr.sh_type, shdr.sh_flags);
 }
@@ -116,7 +119,8 @@ void InputSection<E>::dispatch(Context<E> &ctx, Action table[3][4], i64 i,
 
     assert(sym.is_imported);
     needs_dynrel[i] = true;
-    file.num_dynrel++;
+    if (!ctx.arg.pack_dyn_relocs_android)
+      file.num_dynrel++;
     return;
   case BASEREL:
     if (!is_writable) {
@@ -0,0 +1,490 @@
+// This file implements LTO (link-time optimization) on top of the
+// linker plugin interface, which is supported by both LLVM (LLVMgold.so)
+// and GCC (liblto_plugin.so). See lto.h for the overview of the protocol.
+//
+// An IR object file is represented as an ObjectFile with no sections.
+// Its symbols are given by the plugin and converted to ELF symbols, so
+// that the IR file participates in symbol resolution and archive member
+// selection just like a regular object file. Once symbols are resolved,
+// we pass the results to the plugin, which compiles IR files into native
+// object files (possibly in parallel using multiple processes). We then
+// replace the IR files with the returned object files and resolve
+// symbols again.
+//
+// The plugin API is a C API whose callbacks don't take a context
+// argument, so the state of the plugin lives in global variables. That
+// is fine because we load a plugin at most once in a process.
+
+#include "mold.h"
+#include "lto.h"
+#include "../filetype.h"
+
+#include <cstdarg>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_for_each.h>
+
+namespace mold::elf {
+
+static void *gctx;
+static ClaimFileHandler *claim_file_hook;
+static AllSymbolsReadHandler *all_symbols_read_hook;
+static CleanupHandler *cleanup_hook;
+
+// Symbols given by the plugin for the file currently being claimed
+static std::vector<PluginSymbol> plugin_symbols;
+
+// File descriptors handed out by get_input_file()
+static std::unordered_map<const void *, int> input_file_fds;
+
+template <typename E>
+static Context<E> &get_context() {
+  return *(Context<E> *)gctx;
+}
+
+template <typename E>
+static PluginStatus message(int level, const char *fmt, ...) {
+  Context<E> &ctx = get_context<E>();
+
+  char buf[1000];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+
+  switch (level) {
+  case LDPL_INFO:
+    SyncOut(ctx) << buf;
+    break;
+  case LDPL_WARNING:
+    Warn(ctx) << buf;
+    break;
+  case LDPL_ERROR:
+    Error(ctx) << buf;
+    break;
+  case LDPL_FATAL:
+    Fatal(ctx) << buf;
+  }
+  return LDPS_OK;
+}
+
+static PluginStatus register_claim_file_hook(ClaimFileHandler fn) {
+  claim_file_hook = fn;
+  return LDPS_OK;
+}
+
+static PluginStatus register_all_symbols_read_hook(AllSymbolsReadHandler fn) {
+  all_symbols_read_hook = fn;
+  return LDPS_OK;
+}
+
+static PluginStatus register_cleanup_hook(CleanupHandler fn) {
+  cleanup_hook = fn;
+  return LDPS_OK;
+}
+
+static PluginStatus
+add_symbols(void *handle, int nsyms, const PluginSymbol *psyms) {
+  plugin_symbols.assign(psyms, psyms + nsyms);
+  return LDPS_OK;
+}
+
+// The plugin calls this function to give us a native object file
+// compiled from IR files.
+template <typename E>
+static PluginStatus add_input_file(const char *path) {
+  Context<E> &ctx = get_context<E>();
+
+  MappedFile<Context<E>> *mf = MappedFile<Context<E>>::must_open(ctx, path);
+  if (get_file_type(mf) != FileType::ELF_OBJ)
+    Fatal(ctx) << path << ": LTO plugin returned a non-ELF object file";
+
+  ObjectFile<E> *file = ObjectFile<E>::create(ctx, mf, "", false);
+  file->priority = ctx.file_priority++;
+  ctx.tg.run([file, &ctx]() { file->parse(ctx); });
+  ctx.objs.push_back(file);
+  return LDPS_OK;
+}
+
+template <typename E>
+static PluginStatus add_input_library(const char *path) {
+  Context<E> &ctx = get_context<E>();
+  read_file(ctx, find_library(ctx, path));
+  return LDPS_OK;
+}
+
+template <typename E>
+static PluginStatus set_extra_library_path(const char *path) {
+  get_context<E>().arg.library_paths.push_back(path);
+  return LDPS_OK;
+}
+
+template <typename E>
+static PluginInputFile
+create_plugin_input_file(Context<E> &ctx, ObjectFile<E> &file) {
+  // If a file is an archive member, the plugin reads it from the
+  // archive file at a given offset.
+  MappedFile<Context<E>> *mf = file.mf;
+  MappedFile<Context<E>> *parent = mf->parent ? mf->parent : mf;
+
+  std::string path = parent->name;
+  if (path.starts_with('/') && !ctx.arg.chroot.empty())
+    path = ctx.arg.chroot + "/" + path_clean(path);
+
+  PluginInputFile ret;
+  ret.name = save_string(ctx, path).data();
+  ret.fd = ::open(ret.name, O_RDONLY);
+  if (ret.fd == -1)
+    Fatal(ctx) << "cannot open " << path << ": " << errno_string();
+  ret.offset = mf->data - parent->data;
+  ret.filesize = mf->size;
+  ret.handle = &file;
+  return ret;
+}
+
+template <typename E>
+static PluginStatus get_input_file(const void *handle, PluginInputFile *file) {
+  Context<E> &ctx = get_context<E>();
+  *file = create_plugin_input_file(ctx, *(ObjectFile<E> *)handle);
+  input_file_fds[handle] = file->fd;
+  return LDPS_OK;
+}
+
+static PluginStatus release_input_file(const void *handle) {
+  auto it = input_file_fds.find(handle);
+  if (it == input_file_fds.end())
+    return LDPS_BAD_HANDLE;
+  close(it->second);
+  input_file_fds.erase(it);
+  return LDPS_OK;
+}
+
+template <typename E>
+static PluginStatus get_view(const void *handle, const void **view) {
+  *view = ((ObjectFile<E> *)handle)->mf->data;
+  return LDPS_OK;
+}
+
+// Returns the symbol resolution results to the plugin. This is called
+// from all_symbols_read_hook().
+template <typename E>
+static PluginStatus
+get_symbols(const void *handle, int nsyms, PluginSymbol *psyms, int version) {
+  Context<E> &ctx = get_context<E>();
+  ObjectFile<E> &file = *(ObjectFile<E> *)handle;
+  assert(file.is_lto_obj);
+
+  // If an IR file is an archive member that was not pulled in, the
+  // plugin shouldn't compile it.
+  if (!file.is_alive) {
+    for (i64 i = 0; i < nsyms; i++)
+      psyms[i].resolution = LDPR_PREEMPTED_REG;
+    return (version == 3) ? LDPS_NO_SYMS : LDPS_OK;
+  }
+
+  auto get_resolution = [&](const ElfSym<E> &esym, Symbol<E> &sym) {
+    if (!sym.file)
+      return LDPR_UNDEF;
+
+    if (sym.file == &file) {
+      if (sym.referenced_by_regular_obj)
+        return LDPR_PREVAILING_DEF;
+      if ((ctx.arg.shared || ctx.arg.export_dynamic) &&
+          sym.visibility != STV_HIDDEN)
+        return (version == 1) ? LDPR_PREVAILING_DEF
+                              : LDPR_PREVAILING_DEF_IRONLY_EXP;
+      return LDPR_PREVAILING_DEF_IRONLY;
+    }
+
+    if (sym.file->is_dso)
+      return LDPR_RESOLVED_DYN;
+
+    if (((ObjectFile<E> *)sym.file)->is_lto_obj)
+      return esym.is_undef() ? LDPR_RESOLVED_IR : LDPR_PREEMPTED_IR;
+    return esym.is_undef() ? LDPR_RESOLVED_EXEC : LDPR_PREEMPTED_REG;
+  };
+
+  assert(nsyms + 1 == file.elf_syms.size());
+  for (i64 i = 0; i < nsyms; i++)
+    psyms[i].resolution = get_resolution(file.elf_syms[i + 1],
+                                         *file.symbols[i + 1]);
+  return LDPS_OK;
+}
+
+template <typename E>
+static PluginStatus
+get_symbols_v1(const void *handle, int nsyms, PluginSymbol *psyms) {
+  return get_symbols<E>(handle, nsyms, psyms, 1);
+}
+
+template <typename E>
+static PluginStatus
+get_symbols_v2(const void *handle, int nsyms, PluginSymbol *psyms) {
+  return get_symbols<E>(handle, nsyms, psyms, 2);
+}
+
+template <typename E>
+static PluginStatus
+get_symbols_v3(const void *handle, int nsyms, PluginSymbol *psyms) {
+  return get_symbols<E>(handle, nsyms, psyms, 3);
+}
+
+template <typename E>
+static void load_plugin(Context<E> &ctx) {
+  Timer t(ctx, "load_plugin");
+
+  gctx = &ctx;
+
+  void *handle = dlopen(ctx.arg.plugin.c_str(), RTLD_NOW | RTLD_GLOBAL);
+  if (!handle)
+    Fatal(ctx) << "could not open plugin file: " << dlerror();
+
+  OnloadFn *onload = (OnloadFn *)dlsym(handle, "onload");
+  if (!onload)
+    Fatal(ctx) << ctx.arg.plugin << ": onload not found: " << dlerror();
+
+  std::vector<PluginTagValue> tv;
+
+  auto add = [&](PluginTag tag) -> PluginTagValue & {
+    tv.push_back({});
+    tv.back().tag = tag;
+    return tv.back();
+  };
+
+  add(LDPT_API_VERSION).val = LD_PLUGIN_API_VERSION;
+
+  if (ctx.arg.shared)
+    add(LDPT_LINKER_OUTPUT).val = LDPO_DYN;
+  else if (ctx.arg.pie)
+    add(LDPT_LINKER_OUTPUT).val = LDPO_PIE;
+  else
+    add(LDPT_LINKER_OUTPUT).val = LDPO_EXEC;
+
+  add(LDPT_OUTPUT_NAME).str = ctx.arg.output.c_str();
+
+  for (std::string_view opt : ctx.arg.plugin_opt)
+    add(LDPT_OPTION).str = save_string(ctx, std::string(opt)).data();
+
+  add(LDPT_REGISTER_CLAIM_FILE_HOOK).ptr = (void *)register_claim_file_hook;
+  add(LDPT_REGISTER_ALL_SYMBOLS_READ_HOOK).ptr =
+    (void *)register_all_symbols_read_hook;
+  add(LDPT_REGISTER_CLEANUP_HOOK).ptr = (void *)register_cleanup_hook;
+  add(LDPT_ADD_SYMBOLS).ptr = (void *)add_symbols;
+  add(LDPT_GET_SYMBOLS).ptr = (void *)get_symbols_v1<E>;
+  add(LDPT_ADD_INPUT_FILE).ptr = (void *)add_input_file<E>;
+  add(LDPT_MESSAGE).ptr = (void *)message<E>;
+  add(LDPT_GET_INPUT_FILE).ptr = (void *)get_input_file<E>;
+  add(LDPT_RELEASE_INPUT_FILE).ptr = (void *)release_input_file;
+  add(LDPT_ADD_INPUT_LIBRARY).ptr = (void *)add_input_library<E>;
+  add(LDPT_SET_EXTRA_LIBRARY_PATH).ptr = (void *)set_extra_library_path<E>;
+  add(LDPT_GET_VIEW).ptr = (void *)get_view<E>;
+  add(LDPT_GET_SYMBOLS_V2).ptr = (void *)get_symbols_v2<E>;
+  add(LDPT_GET_SYMBOLS_V3).ptr = (void *)get_symbols_v3<E>;
+  add(LDPT_NULL);
+
+  if (onload(tv.data()) != LDPS_OK)
+    Fatal(ctx) << ctx.arg.plugin << ": onload failed";
+  if (!claim_file_hook)
+    Fatal(ctx) << ctx.arg.plugin << ": no claim-file hook was registered";
+}
+
+template <typename E>
+static ElfSym<E> to_elf_sym(const PluginSymbol &psym) {
+  ElfSym<E> esym = {};
+  esym.st_bind = STB_GLOBAL;
+
+  switch (psym.def) {
+  case LDPK_WEAKDEF:
+    esym.st_bind = STB_WEAK;
+    [[fallthrough]];
+  case LDPK_DEF:
+    esym.st_shndx = SHN_ABS;
+    break;
+  case LDPK_WEAKUNDEF:
+    esym.st_bind = STB_WEAK;
+    [[fallthrough]];
+  case LDPK_UNDEF:
+    esym.st_shndx = SHN_UNDEF;
+    break;
+  case LDPK_COMMON:
+    esym.st_shndx = SHN_COMMON;
+    esym.st_value = 1;
+    esym.st_size = psym.size;
+    break;
+  }
+
+  switch (psym.symbol_type) {
+  case LDST_FUNCTION:
+    esym.st_type = STT_FUNC;
+    break;
+  case LDST_VARIABLE:
+    esym.st_type = STT_OBJECT;
+    break;
+  default:
+    esym.st_type = STT_NOTYPE;
+  }
+
+  switch (psym.visibility) {
+  case LDPV_PROTECTED:
+    esym.st_visibility = STV_PROTECTED;
+    break;
+  case LDPV_INTERNAL:
+  case LDPV_HIDDEN:
+    esym.st_visibility = STV_HIDDEN;
+    break;
+  default:
+    esym.st_visibility = STV_DEFAULT;
+  }
+  return esym;
+}
+
+// GCC LTO object files are ELF files containing IR in special sections.
+// A "slim" object contains only IR, which is marked by a common symbol
+// `__gnu_lto_slim` following section and file symbols. A "fat" object
+// contains native code as well, so it can be linked as a regular file.
+template <typename E>
+bool is_gcc_lto_obj(Context<E> &ctx, MappedFile<Context<E>> *mf) {
+  u8 *data = mf->data;
+  ElfEhdr<E> &ehdr = *(ElfEhdr<E> *)data;
+  ElfShdr<E> *shdrs = (ElfShdr<E> *)(data + ehdr.e_shoff);
+
+  if (data + mf->size < (u8 *)(shdrs + ehdr.e_shnum))
+    return false;
+
+  for (ElfShdr<E> &shdr : std::span(shdrs, ehdr.e_shnum)) {
+    if (shdr.sh_type != SHT_SYMTAB || shdr.sh_link >= ehdr.e_shnum)
+      continue;
+
+    std::span<ElfSym<E>> esyms((ElfSym<E> *)(data + shdr.sh_offset),
+                               shdr.sh_size / sizeof(ElfSym<E>));
+    char *strtab = (char *)data + shdrs[shdr.sh_link].sh_offset;
+
+    for (i64 i = 1; i < esyms.size(); i++) {
+      ElfSym<E> &esym = esyms[i];
+      if (esym.st_type == STT_SECTION || esym.st_type == STT_FILE)
+        continue;
+      return esym.is_common() &&
+             std::string_view(strtab + esym.st_name) == "__gnu_lto_slim";
+    }
+    return false;
+  }
+  return false;
+}
+
+template <typename E>
+ObjectFile<E> *read_lto_object(Context<E> &ctx, MappedFile<Context<E>> *mf) {
+  if (ctx.arg.plugin.empty())
+    Fatal(ctx) << mf->name << ": this is an LTO object file, but no "
+               << "--plugin option was given; make sure that you pass "
+               << "-flto not only when compiling but also when linking";
+
+  static std::once_flag flag;
+  std::call_once(flag, [&] { load_plugin(ctx); });
+
+  ObjectFile<E> *obj = new ObjectFile<E>;
+  ctx.obj_pool.push_back(std::unique_ptr<ObjectFile<E>>(obj));
+
+  obj->mf = mf;
+  obj->filename = mf->name;
+  obj->is_lto_obj = true;
+
+  // claim_file_hook() calls add_symbols() to set `plugin_symbols`.
+  PluginInputFile file = create_plugin_input_file(ctx, *obj);
+  int claimed = false;
+  plugin_symbols.clear();
+  claim_file_hook(&file, &claimed);
+  close(file.fd);
+
+  if (!claimed)
+    Fatal(ctx) << mf->name << ": not claimed by the LTO plugin; make "
+               << "sure that the file was created by the same compiler "
+               << "as the plugin";
+
+  obj->lto_elf_syms.resize(plugin_symbols.size() + 1);
+  obj->symbols.push_back(new Symbol<E>);
+  obj->first_global = 1;
+
+  for (i64 i = 0; i < plugin_symbols.size(); i++) {
+    PluginSymbol &psym = plugin_symbols[i];
+    obj->lto_elf_syms[i + 1] = to_elf_sym<E>(psym);
+    obj->symbols.push_back(get_symbol(ctx, save_string(ctx, psym.name)));
+  }
+
+  obj->elf_syms = obj->lto_elf_syms;
+  obj->sym_fragments.resize(obj->elf_syms.size());
+
+  ctx.has_lto_object = true;
+  return obj;
+}
+
+// Compile IR object files into native object files. Resulting files
+// are appended to ctx.objs.
+template <typename E>
+void do_lto(Context<E> &ctx) {
+  Timer t(ctx, "do_lto");
+
+  // Tell the plugin which IR symbols are referenced from outside IR
+  // files, so that it doesn't remove or internalize them.
+  auto mark = [&](Symbol<E> *sym) {
+    std::scoped_lock lock(sym->mu);
+    sym->referenced_by_regular_obj = true;
+  };
+
+  tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
+    if (!file->is_lto_obj)
+      for (Symbol<E> *sym : file->get_global_syms())
+        mark(sym);
+  });
+
+  tbb::parallel_for_each(ctx.dsos, [&](SharedFile<E> *file) {
+    for (Symbol<E> *sym : file->symbols)
+      mark(sym);
+  });
+
+  for (std::string_view name : ctx.arg.undefined)
+    mark(get_symbol(ctx, name));
+  for (std::string_view name : ctx.arg.require_defined)
+    mark(get_symbol(ctx, name));
+  mark(get_symbol(ctx, ctx.arg.entry));
+  mark(get_symbol(ctx, ctx.arg.init));
+  mark(get_symbol(ctx, ctx.arg.fini));
+
+  // all_symbols_read_hook() calls get_symbols() for each IR file and
+  // add_input_file() for each compiled file.
+  i64 num_objs = ctx.objs.size();
+
+  if (all_symbols_read_hook && all_symbols_read_hook() != LDPS_OK)
+    Fatal(ctx) << ctx.arg.plugin << ": LTO failed";
+
+  ctx.tg.wait();
+  ctx.checkpoint();
+
+  static Counter counter("lto_output_objs");
+  counter += ctx.objs.size() - num_objs;
+
+  tbb::parallel_for((i64)num_objs, (i64)ctx.objs.size(), [&](i64 i) {
+    ctx.objs[i]->register_section_pieces(ctx);
+  });
+}
+
+// Let the plugin remove its temporary files.
+template <typename E>
+void lto_cleanup(Context<E> &ctx) {
+  Timer t(ctx, "lto_cleanup");
+  if (cleanup_hook)
+    cleanup_hook();
+}
+
+#define INSTANTIATE(E)                                                  \
+  template bool is_gcc_lto_obj(Context<E> &, MappedFile<Context<E>> *); \
+  template ObjectFile<E> *                                              \
+  read_lto_object(Context<E> &, MappedFile<Context<E>> *);              \
+  template void do_lto(Context<E> &);                                   \
+  template void lto_cleanup(Context<E> &);
+
+INSTANTIATE(X86_64);
+INSTANTIATE(I386);
+INSTANTIATE(ARM64);
+
+} // namespace mold::elf
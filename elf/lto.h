@@ -0,0 +1,162 @@
+#pragma once
+
+// This file defines the linker plugin interface, which is used by
+// compilers' LTO support (LLVMgold.so and GCC's liblto_plugin.so).
+// The interface is defined by GNU's include/plugin-api.h. We define
+// our own copy here because that header is not always installed.
+//
+// The protocol works as follows:
+//
+//  1. The linker dlopen's a plugin and calls its `onload` function
+//     with a list of linker callbacks and plugin options.
+//
+//  2. When the linker finds an IR object file, it calls a claim-file
+//     hook registered by the plugin. The plugin returns a list of
+//     symbols defined or referenced by the IR file via add_symbols().
+//
+//  3. The linker resolves symbols as usual. Then it calls an
+//     all-symbols-read hook. The plugin asks for the resolution
+//     results with get_symbols(), compiles IR files into native
+//     object files and passes them back to the linker with
+//     add_input_file().
+//
+//  4. The linker links the returned object files instead of the IR
+//     files and calls a cleanup hook at the end.
+
+#include <cstdint>
+#include <sys/types.h>
+
+namespace mold::elf {
+
+enum PluginStatus {
+  LDPS_OK,
+  LDPS_NO_SYMS,
+  LDPS_BAD_HANDLE,
+  LDPS_ERR,
+};
+
+enum PluginTag {
+  LDPT_NULL,
+  LDPT_API_VERSION,
+  LDPT_GOLD_VERSION,
+  LDPT_LINKER_OUTPUT,
+  LDPT_OPTION,
+  LDPT_REGISTER_CLAIM_FILE_HOOK,
+  LDPT_REGISTER_ALL_SYMBOLS_READ_HOOK,
+  LDPT_REGISTER_CLEANUP_HOOK,
+  LDPT_ADD_SYMBOLS,
+  LDPT_GET_SYMBOLS,
+  LDPT_ADD_INPUT_FILE,
+  LDPT_MESSAGE,
+  LDPT_GET_INPUT_FILE,
+  LDPT_RELEASE_INPUT_FILE,
+  LDPT_ADD_INPUT_LIBRARY,
+  LDPT_OUTPUT_NAME,
+  LDPT_SET_EXTRA_LIBRARY_PATH,
+  LDPT_GNU_LD_VERSION,
+  LDPT_GET_VIEW,
+  LDPT_GET_INPUT_SECTION_COUNT,
+  LDPT_GET_INPUT_SECTION_TYPE,
+  LDPT_GET_INPUT_SECTION_NAME,
+  LDPT_GET_INPUT_SECTION_CONTENTS,
+  LDPT_UPDATE_SECTION_ORDER,
+  LDPT_ALLOW_SECTION_ORDERING,
+  LDPT_GET_SYMBOLS_V2,
+  LDPT_ALLOW_UNIQUE_SEGMENT_FOR_SECTIONS,
+  LDPT_UNIQUE_SEGMENT_FOR_SECTIONS,
+  LDPT_GET_SYMBOLS_V3,
+  LDPT_GET_INPUT_SECTION_ALIGNMENT,
+  LDPT_GET_INPUT_SECTION_SIZE,
+  LDPT_REGISTER_NEW_INPUT_HOOK,
+  LDPT_GET_WRAP_SYMBOLS,
+  LDPT_ADD_SYMBOLS_V2,
+};
+
+enum PluginApiVersion {
+  LD_PLUGIN_API_VERSION = 1,
+};
+
+struct PluginTagValue {
+  PluginTag tag;
+  union {
+    int val;
+    const char *str;
+    void *ptr;
+  };
+};
+
+enum PluginOutputFileType {
+  LDPO_REL,
+  LDPO_EXEC,
+  LDPO_DYN,
+  LDPO_PIE,
+};
+
+struct PluginInputFile {
+  const char *name;
+  int fd;
+  off_t offset;
+  off_t filesize;
+  void *handle;
+};
+
+struct PluginSymbol {
+  char *name;
+  char *version;
+  uint8_t def;
+  uint8_t symbol_type;
+  uint8_t section_kind;
+  uint8_t unused;
+  int visibility;
+  uint64_t size;
+  char *comdat_key;
+  int resolution;
+};
+
+enum PluginSymbolKind {
+  LDPK_DEF,
+  LDPK_WEAKDEF,
+  LDPK_UNDEF,
+  LDPK_WEAKUNDEF,
+  LDPK_COMMON,
+};
+
+enum PluginSymbolVisibility {
+  LDPV_DEFAULT,
+  LDPV_PROTECTED,
+  LDPV_INTERNAL,
+  LDPV_HIDDEN,
+};
+
+enum PluginSymbolType {
+  LDST_UNKNOWN,
+  LDST_FUNCTION,
+  LDST_VARIABLE,
+};
+
+enum PluginSymbolResolution {
+  LDPR_UNKNOWN,
+  LDPR_UNDEF,
+  LDPR_PREVAILING_DEF,
+  LDPR_PREVAILING_DEF_IRONLY,
+  LDPR_PREEMPTED_REG,
+  LDPR_PREEMPTED_IR,
+  LDPR_RESOLVED_IR,
+  LDPR_RESOLVED_EXEC,
+  LDPR_RESOLVED_DYN,
+  LDPR_PREVAILING_DEF_IRONLY_EXP,
+};
+
+enum PluginLevel {
+  LDPL_INFO,
+  LDPL_WARNING,
+  LDPL_ERROR,
+  LDPL_FATAL,
+};
+
+typedef PluginStatus OnloadFn(PluginTagValue *tv);
+typedef PluginStatus ClaimFileHandler(const PluginInputFile *, int *);
+typedef PluginStatus AllSymbolsReadHandler();
+typedef PluginStatus CleanupHandler();
+
+} // namespace mold::elf
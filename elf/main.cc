@@ -16,12 +16,30 @@
 
 namespace mold::elf {
 
+template <typename E>
+static ObjectFile<E> *new_lto_obj(Context<E> &ctx, MappedFile<Context<E>> *mf,
+                                  std::string archive_name) {
+  static Counter count("parsed_lto_objs");
+  count++;
+
+  ObjectFile<E> *file = read_lto_object(ctx, mf);
+  file->priority = ctx.file_priority++;
+  file->archive_name = archive_name;
+  file->is_alive = !ctx.in_lib && (archive_name.empty() || ctx.whole_archive);
+  if (ctx.arg.trace)
+    SyncOut(ctx) << "trace: " << *file;
+  return file;
+}
+
 template <typename E>
 static ObjectFile<E> *new_object_file(Context<E> &ctx, MappedFile<Context<E>> *mf,
                                       std::string archive_name) {
   if (i64 type = ((ElfEhdr<E> *)mf->data)->e_machine; type != E::e_machine)
     Fatal(ctx) << mf->name << ": incompatible file type: " << type;
 
+  if (is_gcc_lto_obj(ctx, mf))
+    return new_lto_obj(ctx, mf, archive_name);
+
   static Counter count("parsed_objs");
   count++;
 
@@ -53,6 +71,9 @@ void read_file(Context<E> &ctx, MappedFile<Context<E>> *mf) {
   if (ctx.visited.contains(mf->name))
     return;
 
+  if (ctx.arg.huge_pages)
+    madvise_huge_pages(mf->data, mf->size);
+
   FileType type = get_file_type(mf);
   switch (type) {
   case FileType::ELF_OBJ:
@@ -64,18 +85,25 @@ void read_file(Context<E> &ctx, MappedFile<Context<E>> *mf) {
     return;
   case FileType::AR:
   case FileType::THIN_AR:
-    for (MappedFile<Context<E>> *child : read_archive_members(ctx, mf))
-      if (get_file_type(child) == FileType::ELF_OBJ)
+    for (MappedFile<Context<E>> *child : read_archive_members(ctx, mf)) {
+      switch (get_file_type(child)) {
+      case FileType::ELF_OBJ:
         ctx.objs.push_back(new_object_file(ctx, child, mf->name));
+        break;
+      case FileType::LLVM_BITCODE:
+        ctx.objs.push_back(new_lto_obj(ctx, child, mf->name));
+        break;
+      default:
+        break;
+      }
+    }
     ctx.visited.insert(mf->name);
     return;
   case FileType::TEXT:
     parse_linker_script(ctx, mf);
     return;
   case FileType::LLVM_BITCODE:
-    Warn(ctx) << mf->name << ": looks like this is an LLVM bitcode, "
-              << "but mold does not support LTO";
-    ctx.llvm_lto = true;
+    ctx.objs.push_back(new_lto_obj(ctx, mf, ""));
     return;
   default:
     Fatal(ctx) << mf->name << ": unknown file type: " << type;
@@ -268,7 +296,7 @@ static void show_stats(Context<E> &ctx) {
     static Counter undefined("undefined_syms");
     undefined += obj->symbols.size() - obj->first_global;
 
-    for (std::unique_ptr<InputSection<E>> &sec : obj->sections) {
+    for (InputSection<E> *sec : obj->sections) {
       if (!sec || !sec->is_alive)
         continue;
 
@@ -313,6 +341,11 @@ static void show_stats(Context<E> &ctx) {
   static Counter num_objs("num_objs", ctx.objs.size());
   static Counter num_dsos("num_dsos", ctx.dsos.size());
 
+  // In-memory sizes of our most numerous data structures
+  static Counter symbol_bytes("bytes_per_symbol", sizeof(Symbol<E>));
+  static Counter fragment_bytes("bytes_per_fragment",
+                                sizeof(SectionFragment<E>));
+
   if constexpr (E::e_machine == EM_AARCH64) {
     static Counter num_thunks("num_thunks");
     for (std::unique_ptr<OutputSection<E>> &osec : ctx.output_sections)
@@ -442,27 +475,10 @@ static int elf_main(int argc, char **argv) {
   create_synthetic_sections(ctx);
 
   // Resolve symbols and fix the set of object files that are
-  // included to the final output.
+  // included to the final output. If there are IR object files,
+  // they are compiled to native code by the LTO plugin here.
   resolve_symbols(ctx);
 
-  // We currently do not natively support LTO.
-  // If LLVM LTO is in use, fallback to the lld linker by invoking
-  // it with the exact same command line arguments as we got.
-  if (ctx.llvm_lto) {
-    Warn(ctx) << "LLVM LTO is detected, so falling back to ld.lld";
-    argv[0] = (char *)"ld.lld";
-    execvp("ld.lld", argv);
-    Fatal(ctx) << "execvp failed: ld.lld: " << errno_string();
-  }
-
-  // Do the same for GCC LTO.
-  if (Symbol<E> *sym = get_symbol(ctx, "__gnu_lto_slim"); sym->file) {
-    Warn(ctx) << *sym->file
-              << "GCC LTO is detected, so falling back to ld.bfd";
-    execvp("ld.bfd", argv);
-    Fatal(ctx) << "execvp failed: ld.bfd: " << errno_string();
-  }
-
   // Remove redundant comdat sections (e.g. duplicate inline functions).
   eliminate_comdats(ctx);
 
@@ -532,6 +548,13 @@ static int elf_main(int argc, char **argv) {
   // a special rule. Sort them.
   sort_init_fini(ctx);
 
+  // Reorder functions if requested by --symbol-ordering-file or
+  // call graph profiles.
+  if (!ctx.arg.symbol_ordering_file.empty())
+    sort_by_symbol_ordering_file(ctx);
+  else if (ctx.arg.call_graph_profile_sort)
+    sort_by_call_graph_profile(ctx);
+
   // Compute sizes of output sections while assigning offsets
   // within an output section to input sections.
   compute_section_sizes(ctx);
@@ -569,6 +592,12 @@ static int elf_main(int argc, char **argv) {
   // be added to .dynsym.
   ctx.dynsym->finalize(ctx);
 
+  // If --pack-dyn-relocs=android was given, dynamic relocations against
+  // imported symbols are stored to .android.rela.dyn in a compressed
+  // form. We need to do this after fixing dynamic symbol indices.
+  if (ctx.arg.pack_dyn_relocs_android)
+    construct_android_relocs(ctx);
+
   // Fill .gnu.version_d section contents.
   ctx.verdef->construct(ctx);
 
@@ -583,6 +612,12 @@ static int elf_main(int argc, char **argv) {
     });
   }
 
+  // Deduplicate symbol names and assign .strtab offsets to them.
+  {
+    Timer t(ctx, "strtab");
+    ctx.strtab->construct(ctx);
+  }
+
   // .eh_frame is a special section from the linker's point of view,
   // as its contents are parsed and reconstructed by the linker,
   // unlike other sections that are regarded as opaque bytes.
@@ -625,6 +660,13 @@ static int elf_main(int argc, char **argv) {
   // Fix linker-synthesized symbol addresses.
   fix_synthetic_symbols(ctx);
 
+  // Now that all symbol addresses are fixed, cache them for relocation
+  // processing. This has to be done before compressing debug sections
+  // because the compressor applies relocations to the sections it
+  // compresses. Compression changes only non-alloc sections, so it
+  // doesn't invalidate the cached addresses.
+  compute_symbol_addrs(ctx);
+
   // If --compress-debug-sections is given, compress .debug_* sections
   // using zlib.
   if (ctx.arg.compress_debug_sections != COMPRESS_NONE) {
@@ -654,6 +696,21 @@ static int elf_main(int argc, char **argv) {
 
   Timer t_copy(ctx, "copy");
 
+  // If the output is a pipe or some other special file, we can write
+  // out the beginning of the file while we are still copying other
+  // chunks. That's possible only if no pass after copy_buf modifies
+  // chunk contents. .rela.dyn and .strtab are written by other chunks'
+  // copy_buf, so they become complete only after all chunks are copied.
+  bool streaming = !ctx.buildid && ctx.arg.filler == -1 &&
+                   E::e_machine != EM_AARCH64;
+
+  if (streaming)
+    ctx.output_file->start_streaming(ctx);
+
+  auto is_deferred = [&](Chunk<E> *chunk) {
+    return chunk == ctx.reldyn.get() || chunk == ctx.strtab.get();
+  };
+
   // Copy input sections to the output file
   {
     Timer t(ctx, "copy_buf");
@@ -665,6 +722,9 @@ static int elf_main(int argc, char **argv) {
       Timer t2(ctx, name, &t);
 
       chunk->copy_buf(ctx);
+
+      if (streaming && !is_deferred(chunk))
+        ctx.output_file->notify_chunk_done(ctx, chunk);
     });
 
     ctx.checkpoint();
@@ -690,6 +750,9 @@ static int elf_main(int argc, char **argv) {
   // Close the output file. This is the end of the linker's main job.
   ctx.output_file->close(ctx);
 
+  if (ctx.has_lto_object)
+    lto_cleanup(ctx);
+
   t_total.stop();
   t_all.stop();
 
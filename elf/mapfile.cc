@@ -1,5 +1,6 @@
 #include "mold.h"
 
+#include <charconv>
 #include <fstream>
 #include <iomanip>
 #include <ios>
@@ -48,8 +49,357 @@ static Map<E> get_map(Context<E> &ctx) {
   return map;
 }
 
+// MapWriter formats a record of a JSON or CSV map file. Each record is
+// formatted twice; first with a null buffer to compute its size, and
+// then to the actual output buffer at an offset computed from the
+// sizes. This allows us to write records in parallel without creating
+// temporary strings.
+class MapWriter {
+public:
+  MapWriter(u8 *buf, bool is_json) : buf(buf), is_json(is_json) {}
+
+  void put(char c) {
+    if (buf)
+      buf[size] = c;
+    size++;
+  }
+
+  void put(std::string_view str) {
+    if (buf)
+      memcpy(buf + size, str.data(), str.size());
+    size += str.size();
+  }
+
+  void put_num(u64 val) {
+    char tmp[20];
+    char *end = std::to_chars(tmp, tmp + sizeof(tmp), val).ptr;
+    put(std::string_view(tmp, end - tmp));
+  }
+
+  // Writes a string as a JSON string literal or as a CSV field.
+  void put_str(std::string_view str) {
+    if (is_json) {
+      put('"');
+      for (char c : str) {
+        if (c == '"' || c == '\\') {
+          put('\\');
+          put(c);
+        } else if ((u8)c < 0x20) {
+          static const char hex[] = "0123456789abcdef";
+          put("\\u00");
+          put(hex[(u8)c >> 4]);
+          put(hex[c & 0xf]);
+        } else {
+          put(c);
+        }
+      }
+      put('"');
+      return;
+    }
+
+    if (str.find_first_of(",\"\n") == str.npos) {
+      put(str);
+      return;
+    }
+
+    put('"');
+    for (char c : str) {
+      if (c == '"')
+        put('"');
+      put(c);
+    }
+    put('"');
+  }
+
+  template <typename E>
+  void put_file(ObjectFile<E> &file) {
+    if (file.archive_name.empty()) {
+      put_str(path_clean(file.filename));
+      return;
+    }
+
+    std::string path = path_clean(file.archive_name);
+    path += "(";
+    path += file.filename;
+    path += ")";
+    put_str(path);
+  }
+
+  u8 *buf;
+  i64 size = 0;
+  bool is_json;
+};
+
+// A group of records that are formatted by the same function.
+struct MapRecords {
+  i64 num_records;
+  std::function<void(MapWriter &, i64)> write;
+  std::vector<i64> offsets = {};
+};
+
+template <typename E>
+static std::string_view get_symbol_name(Context<E> &ctx, Symbol<E> &sym) {
+  if (ctx.arg.demangle)
+    return demangle(sym.name());
+  return sym.name();
+}
+
+// Computes the total size of input sections contributed by each
+// input file and each archive file.
+template <typename E>
+static std::pair<std::vector<i64>, std::vector<std::pair<std::string_view, i64>>>
+get_file_sizes(Context<E> &ctx) {
+  std::vector<i64> file_sizes(ctx.objs.size());
+
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    for (InputSection<E> *isec : ctx.objs[i]->sections)
+      if (isec && isec->is_alive && isec->output_section)
+        file_sizes[i] += isec->shdr.sh_size;
+  });
+
+  std::vector<std::pair<std::string_view, i64>> archive_sizes;
+  std::unordered_map<std::string_view, i64> archive_idx;
+
+  for (i64 i = 0; i < ctx.objs.size(); i++) {
+    std::string_view name = ctx.objs[i]->archive_name;
+    if (name.empty())
+      continue;
+
+    auto [it, inserted] = archive_idx.insert({name, archive_sizes.size()});
+    if (inserted)
+      archive_sizes.push_back({name, 0});
+    archive_sizes[it->second].second += file_sizes[i];
+  }
+  return {file_sizes, archive_sizes};
+}
+
+template <typename E>
+static void print_structured_map(Context<E> &ctx) {
+  bool is_json = (ctx.arg.Map_format == MAP_JSON);
+
+  // Construct a section-to-symbol map and compute per-file sizes.
+  Map<E> map = get_map(ctx);
+  auto [file_sizes, archive_sizes] = get_file_sizes(ctx);
+
+  std::vector<MapRecords> groups;
+
+  auto add_string = [&](std::string_view str) {
+    groups.push_back({1, [=](MapWriter &w, i64) { w.put(str); }});
+  };
+
+  if (is_json)
+    add_string("{\n  \"output_sections\": [");
+  else
+    add_string("kind,address,size,align,output_section,file,input_section,symbol\n");
+
+  // Records for output sections. The first record of each group is an
+  // output section, followed by its member input sections. The last
+  // record closes the output section.
+  for (i64 i = 0; i < ctx.chunks.size(); i++) {
+    Chunk<E> *osec = ctx.chunks[i];
+
+    std::span<InputSection<E> *> members;
+    if (osec->kind == Chunk<E>::REGULAR)
+      members = ((OutputSection<E> *)osec)->members;
+
+    auto write = [=, &ctx, &map](MapWriter &w, i64 j) {
+      if (j == 0) {
+        if (is_json) {
+          w.put(i ? ",\n    {\"name\": " : "\n    {\"name\": ");
+          w.put_str(osec->name);
+          w.put(", \"address\": ");
+          w.put_num(osec->shdr.sh_addr);
+          w.put(", \"size\": ");
+          w.put_num(osec->shdr.sh_size);
+          w.put(", \"align\": ");
+          w.put_num(osec->shdr.sh_addralign);
+          w.put(", \"input_sections\": [");
+        } else {
+          w.put("section,");
+          w.put_num(osec->shdr.sh_addr);
+          w.put(',');
+          w.put_num(osec->shdr.sh_size);
+          w.put(',');
+          w.put_num(osec->shdr.sh_addralign);
+          w.put(',');
+          w.put_str(osec->name);
+          w.put(",,,\n");
+        }
+        return;
+      }
+
+      if (j == members.size() + 1) {
+        if (is_json)
+          w.put(members.empty() ? "]}" : "\n    ]}");
+        return;
+      }
+
+      InputSection<E> *mem = members[j - 1];
+      u64 addr = osec->shdr.sh_addr + mem->get_offset();
+
+      std::span<Symbol<E> *const> syms;
+      typename Map<E>::const_accessor acc;
+      if (map.find(acc, mem))
+        syms = acc->second;
+
+      if (is_json) {
+        w.put(j == 1 ? "\n      {\"file\": " : ",\n      {\"file\": ");
+        w.put_file(mem->file);
+        w.put(", \"name\": ");
+        w.put_str(mem->name());
+        w.put(", \"address\": ");
+        w.put_num(addr);
+        w.put(", \"size\": ");
+        w.put_num(mem->shdr.sh_size);
+        w.put(", \"align\": ");
+        w.put_num(mem->shdr.sh_addralign);
+        w.put(", \"symbols\": [");
+
+        for (i64 k = 0; k < syms.size(); k++) {
+          w.put(k ? ", {\"name\": " : "{\"name\": ");
+          w.put_str(get_symbol_name(ctx, *syms[k]));
+          w.put(", \"address\": ");
+          w.put_num(syms[k]->get_addr(ctx));
+          w.put('}');
+        }
+        w.put("]}");
+        return;
+      }
+
+      auto put_common = [&] {
+        w.put(',');
+        w.put_str(osec->name);
+        w.put(',');
+        w.put_file(mem->file);
+        w.put(',');
+        w.put_str(mem->name());
+        w.put(',');
+      };
+
+      w.put("input,");
+      w.put_num(addr);
+      w.put(',');
+      w.put_num(mem->shdr.sh_size);
+      w.put(',');
+      w.put_num(mem->shdr.sh_addralign);
+      put_common();
+      w.put('\n');
+
+      for (Symbol<E> *sym : syms) {
+        w.put("symbol,");
+        w.put_num(sym->get_addr(ctx));
+        w.put(",,");
+        put_common();
+        w.put_str(get_symbol_name(ctx, *sym));
+        w.put('\n');
+      }
+    };
+
+    groups.push_back({(i64)members.size() + 2, write});
+  }
+
+  // Per-file size totals
+  if (is_json)
+    add_string("\n  ],\n  \"input_files\": [");
+
+  groups.push_back({(i64)ctx.objs.size(), [&](MapWriter &w, i64 i) {
+    ObjectFile<E> *file = ctx.objs[i];
+    if (is_json) {
+      w.put(i ? ",\n    {\"file\": " : "\n    {\"file\": ");
+      w.put_file(*file);
+      w.put(", \"archive\": ");
+      w.put_str(path_clean(file->archive_name));
+      w.put(", \"size\": ");
+      w.put_num(file_sizes[i]);
+      w.put('}');
+    } else {
+      w.put("file,,");
+      w.put_num(file_sizes[i]);
+      w.put(",,,");
+      w.put_file(*file);
+      w.put(",,\n");
+    }
+  }});
+
+  // Per-archive size totals
+  if (is_json)
+    add_string("\n  ],\n  \"archives\": [");
+
+  groups.push_back({(i64)archive_sizes.size(), [&](MapWriter &w, i64 i) {
+    auto [name, size] = archive_sizes[i];
+    if (is_json) {
+      w.put(i ? ",\n    {\"archive\": " : "\n    {\"archive\": ");
+      w.put_str(path_clean(name));
+      w.put(", \"size\": ");
+      w.put_num(size);
+      w.put('}');
+    } else {
+      w.put("archive,,");
+      w.put_num(size);
+      w.put(",,,");
+      w.put_str(path_clean(name));
+      w.put(",,\n");
+    }
+  }});
+
+  if (is_json)
+    add_string("\n  ]\n}\n");
+
+  // Compute the size of each record and convert them to offsets
+  // within each group.
+  std::vector<i64> group_sizes(groups.size());
+
+  tbb::parallel_for((i64)0, (i64)groups.size(), [&](i64 i) {
+    MapRecords &group = groups[i];
+    group.offsets.resize(group.num_records);
+
+    tbb::parallel_for((i64)0, group.num_records, [&](i64 j) {
+      MapWriter w(nullptr, is_json);
+      group.write(w, j);
+      group.offsets[j] = w.size;
+    });
+
+    i64 offset = 0;
+    for (i64 &x : group.offsets) {
+      i64 sz = x;
+      x = offset;
+      offset += sz;
+    }
+    group_sizes[i] = offset;
+  });
+
+  std::vector<i64> group_offsets(groups.size());
+  i64 filesize = 0;
+  for (i64 i = 0; i < groups.size(); i++) {
+    group_offsets[i] = filesize;
+    filesize += group_sizes[i];
+  }
+
+  // Write records to the output buffer.
+  std::string path = ctx.arg.Map.empty() ? "-" : ctx.arg.Map;
+  std::unique_ptr<OutputFile<E>> out =
+    OutputFile<E>::open(ctx, path, filesize, 0666);
+
+  tbb::parallel_for((i64)0, (i64)groups.size(), [&](i64 i) {
+    MapRecords &group = groups[i];
+    tbb::parallel_for((i64)0, group.num_records, [&](i64 j) {
+      MapWriter w(out->buf + group_offsets[i] + group.offsets[j], is_json);
+      group.write(w, j);
+    });
+  });
+
+  out->close(ctx);
+}
+
 template <typename E>
 void print_map(Context<E> &ctx) {
+  Timer t(ctx, "print_map");
+
+  if (ctx.arg.Map_format != MAP_TEXT) {
+    print_structured_map(ctx);
+    return;
+  }
+
   std::ostream *out = &std::cout;
   std::unique_ptr<std::ofstream> file;
 
@@ -81,7 +431,7 @@ void print_map(Context<E> &ctx) {
       std::ostringstream ss;
       opt_demangle = ctx.arg.demangle;
 
-      ss << std::setw(16) << (osec->shdr.sh_addr + mem->offset)
+      ss << std::setw(16) << (osec->shdr.sh_addr + mem->get_offset())
          << std::setw(11) << (u64)mem->shdr.sh_size
          << std::setw(6) << (u64)mem->shdr.sh_addralign
          << "         " << *mem << "\n";
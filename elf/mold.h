@@ -72,17 +72,25 @@ std::ostream &operator<<(std::ostream &out, const Symbol<E> &sym);
 
 template <typename E>
 struct SectionFragment {
-  SectionFragment(MergedSection<E> *sec) : output_section(*sec) {}
+  SectionFragment(MergedSection<E> *sec);
 
   SectionFragment(const SectionFragment &other)
-    : output_section(other.output_section), offset(other.offset),
-      alignment(other.alignment.load()), is_alive(other.is_alive.load()) {}
+    : offset(other.offset), output_section_idx(other.output_section_idx),
+      shard_idx(other.shard_idx), p2align(other.p2align.load()),
+      is_alive(other.is_alive.load()) {}
 
   u64 get_addr(Context<E> &ctx) const;
+  MergedSection<E> &get_output_section(Context<E> &ctx) const;
 
-  MergedSection<E> &output_section;
+  // We may have hundreds of millions of fragments, so this struct
+  // is packed into 8 bytes. Instead of having a pointer to the output
+  // section, it has an index to ctx.merged_sections. `offset` is
+  // relative to the beginning of the shard in the output section, so
+  // a merged section can exceed 4 GiB as long as each shard fits in it.
   u32 offset = -1;
-  std::atomic_uint16_t alignment = 1;
+  u16 output_section_idx : 12 = 0;
+  u16 shard_idx : 4 = 0;
+  std::atomic_uint8_t p2align = 0;
   std::atomic_bool is_alive = false;
 };
 
@@ -254,6 +262,27 @@ struct RangeExtensionRef {
   i32 sym_idx = -1;
 };
 
+// scan_relocations() compiles relocations for an SHF_ALLOC section into
+// a list of RelocOps, so that apply_reloc_alloc() can apply common
+// relocations without decoding relocation types and making the same
+// decisions again. Relocations that don't fit in a simple operation
+// are recorded as GENERIC and handled by the usual per-type code.
+struct RelocOp {
+  enum : u8 {
+    GENERIC, DYNREL, DYNREL_ANDROID, BASEREL, BASEREL_RELR, ABS32, ABS32S,
+    ABS64, PC32, PC64,
+  };
+
+  // For GENERIC, `target` is a relocation index and `addend` is an
+  // index into rel_fragments or -1. Otherwise, `target` is a symbol
+  // index, or an index into rel_fragments if `is_frag` is true.
+  u32 offset;
+  u32 target;
+  i32 addend;
+  u8 kind;
+  bool is_frag;
+};
+
 // InputSection represents a section in an input object file.
 template <typename E>
 class InputSection {
@@ -274,6 +303,8 @@ public:
 
   i64 get_priority() const;
   u64 get_addr() const;
+  u64 get_offset() const;
+  void set_offset(u64 offset);
   i64 get_addend(const ElfRel<E> &rel) const;
   std::span<ElfRel<E>> get_rels(Context<E> &ctx) const;
   std::span<FdeRecord<E>> get_fdes() const;
@@ -287,17 +318,24 @@ public:
   std::unique_ptr<SectionFragmentRef<E>[]> rel_fragments;
   BitVector needs_dynrel;
   BitVector needs_baserel;
+  std::vector<RelocOp> reloc_plan;
   i32 fde_begin = -1;
   i32 fde_end = -1;
 
   const char *nameptr = nullptr;
   i32 namelen = 0;
 
-  u32 offset = -1;
   u32 section_idx = -1;
   u32 relsec_idx = -1;
   u32 reldyn_offset = 0;
 
+  // An offset from the beginning of the output section. Output
+  // sections may be larger than 4 GiB, but we don't want to make
+  // this class larger, so the offset is split into lower 32 bits
+  // and upper 16 bits. Use get_offset() and set_offset() to access it.
+  u32 offset_lo = -1;
+  u16 offset_hi = -1;
+
   // For COMDAT de-duplication and garbage collection
   std::atomic_bool is_alive = true;
 
@@ -309,6 +347,7 @@ public:
   u32 icf_idx = -1;
   bool icf_eligible = false;
   bool icf_leaf = false;
+  std::atomic_bool address_significant = false;
 
   bool is_ehframe = false;
 
@@ -419,6 +458,22 @@ public:
   void copy_buf(Context<E> &ctx) override;
 };
 
+// Symbolic dynamic relocations of an output section encoded in the
+// Android packed relocation format. Relocation offsets are relative
+// to the beginning of the section. The first relocation's offset and
+// addend depend on the preceding section, so they are written as
+// fixed-width placeholders that are filled in by AndroidRelDynSection.
+struct AndroidRelocs {
+  std::vector<u8> buf;
+  i64 num_relocs = 0;
+  i64 offset_pos = 0;
+  i64 addend_pos = -1;
+  u64 first_offset = 0;
+  u64 last_offset = 0;
+  i64 first_addend = 0;
+  i64 last_addend = 0;
+};
+
 // Sections
 template <typename E>
 class OutputSection : public Chunk<E> {
@@ -432,9 +487,20 @@ public:
   std::vector<InputSection<E> *> members;
   u32 idx;
 
+  // Sizes and log2 of alignments of `members`. They are copies of
+  // InputSection's fields, stored contiguously so that the layout
+  // passes don't have to touch each InputSection to read them.
+  // Call update_member_attrs() after reordering `members`.
+  std::vector<u64> member_sizes;
+  std::vector<u8> member_p2aligns;
+  void update_member_attrs();
+
   void construct_relr(Context<E> &ctx);
   std::vector<typename E::WordTy> relr;
 
+  void construct_android_relocs(Context<E> &ctx);
+  AndroidRelocs android_relocs;
+
   std::vector<std::unique_ptr<RangeExtensionThunk<E>>> thunks;
 
 private:
@@ -451,12 +517,6 @@ public:
     this->shdr.sh_addralign = E::word_size;
   }
 
-  void add_got_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_gottp_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_tlsgd_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_tlsdesc_symbol(Context<E> &ctx, Symbol<E> *sym);
-  void add_tlsld(Context<E> &ctx);
-
   u64 get_tlsld_addr(Context<E> &ctx) const;
   i64 get_reldyn_size(Context<E> &ctx) const;
   void copy_buf(Context<E> &ctx) override;
@@ -469,6 +529,9 @@ public:
 
   void construct_relr(Context<E> &ctx);
   std::vector<typename E::WordTy> relr;
+
+  void construct_android_relocs(Context<E> &ctx);
+  AndroidRelocs android_relocs;
 };
 
 template <typename E>
@@ -494,7 +557,6 @@ public:
     this->shdr.sh_addralign = 16;
   }
 
-  void add_symbol(Context<E> &ctx, Symbol<E> *sym);
   void copy_buf(Context<E> &ctx) override;
 
   std::vector<Symbol<E> *> symbols;
@@ -510,7 +572,6 @@ public:
     this->shdr.sh_addralign = E::pltgot_size;
   }
 
-  void add_symbol(Context<E> &ctx, Symbol<E> *sym);
   void copy_buf(Context<E> &ctx) override;
 
   std::vector<Symbol<E> *> symbols;
@@ -564,6 +625,36 @@ public:
   void copy_buf(Context<E> &ctx) override;
 };
 
+// .android.rela.dyn contains symbolic dynamic relocations (e.g.
+// R_*_GLOB_DAT) in the Android packed relocation format (APS2).
+// Other dynamic relocations stay in .rela.dyn.
+template <typename E>
+class AndroidRelDynSection : public Chunk<E> {
+public:
+  AndroidRelDynSection() : Chunk<E>(this->SYNTHETIC) {
+    this->name = E::is_rel ? ".android.rel.dyn" : ".android.rela.dyn";
+    this->shdr.sh_type = E::is_rel ? SHT_ANDROID_REL : SHT_ANDROID_RELA;
+    this->shdr.sh_flags = SHF_ALLOC;
+    this->shdr.sh_entsize = 1;
+    this->shdr.sh_addralign = 1;
+  }
+
+  void update_shdr(Context<E> &ctx) override;
+  void copy_buf(Context<E> &ctx) override;
+};
+
+// A unique string in .strtab. `owner` identifies the first symbol
+// that refers to the string; only that symbol's file writes it.
+struct StrtabEntry {
+  StrtabEntry() = default;
+
+  StrtabEntry(const StrtabEntry &other)
+    : owner(other.owner.load()), offset(other.offset) {}
+
+  std::atomic_uint64_t owner = -1;
+  u32 offset = 0;
+};
+
 template <typename E>
 class StrtabSection : public Chunk<E> {
 public:
@@ -573,7 +664,10 @@ public:
     this->shdr.sh_size = 1;
   }
 
-  void update_shdr(Context<E> &ctx) override;
+  void construct(Context<E> &ctx);
+
+private:
+  ConcurrentMap<StrtabEntry> map;
 };
 
 template <typename E>
@@ -602,8 +696,6 @@ public:
   i64 find_string(std::string_view str);
   void copy_buf(Context<E> &ctx) override;
 
-  i64 dynsym_offset = -1;
-
 private:
   std::unordered_map<std::string_view, i64> strings;
 };
@@ -654,6 +746,7 @@ public:
   void copy_buf(Context<E> &ctx) override;
 
   std::vector<Symbol<E> *> symbols{1};
+  std::vector<u32> name_offsets;
 };
 
 template <typename E>
@@ -692,6 +785,9 @@ public:
 
   u32 num_buckets = -1;
   u32 num_bloom = 1;
+
+  // djb hashes of exported symbols in .dynsym order
+  std::vector<u32> hashes;
 };
 
 template <typename E>
@@ -706,12 +802,17 @@ public:
   void write_to(Context<E> &ctx, u8 *buf) override;
 
   HyperLogLog estimator;
+  std::vector<i64> shard_offsets;
+  std::atomic_bool has_non_strings = false;
+  u16 idx;
 
 private:
-  MergedSection(std::string_view name, u64 flags, u32 type);
+  MergedSection(std::string_view name, u64 flags, u32 type, u16 idx);
+
+  std::vector<std::pair<i64, i64>> find_tail_merged_strings(Context<E> &ctx);
 
   ConcurrentMap<SectionFragment<E>> map;
-  std::vector<i64> shard_offsets;
+  std::vector<bool> is_tail_merged;
   std::once_flag once_flag;
 };
 
@@ -996,17 +1097,40 @@ public:
   InputSection<E> *get_section(const ElfSym<E> &esym);
 
   std::string archive_name;
-  std::vector<std::unique_ptr<InputSection<E>>> sections;
-  std::vector<std::unique_ptr<MergeableSection<E>>> mergeable_sections;
+  std::vector<InputSection<E> *> sections;
+  std::vector<MergeableSection<E> *> mergeable_sections;
   const bool is_in_lib = false;
   std::vector<CieRecord<E>> cies;
   std::vector<FdeRecord<E>> fdes;
   std::vector<const char *> symvers;
   std::vector<SectionFragmentRef<E>> sym_fragments;
   std::vector<std::pair<ComdatGroup *, std::span<u32>>> comdat_groups;
+
+  // Final addresses of `symbols`, i.e. Symbol::get_addr() values.
+  // Filled by compute_symbol_addrs() once the file layout is fixed.
+  std::vector<u64> symbol_addrs;
+
+  // Symbols that relocations for non-alloc sections can't simply
+  // refer to by symbol_addrs, i.e. undefined symbols and section
+  // symbols for mergeable sections.
+  BitVector slow_reloc_syms;
+
+  // .llvm_addrsig section listing address-significant symbols, or
+  // nullptr if this file doesn't have a usable one.
+  const ElfShdr<E> *llvm_addrsig = nullptr;
+
+  // .llvm.call-graph-profile section and its relocation section
+  const ElfShdr<E> *llvm_cgprofile = nullptr;
+  const ElfShdr<E> *llvm_cgprofile_rels = nullptr;
+
   bool exclude_libs = false;
   u32 features = 0;
 
+  // True if this is an IR object file claimed by the LTO plugin. Such
+  // file has only symbols (in `lto_elf_syms`) and no sections.
+  bool is_lto_obj = false;
+  std::vector<ElfSym<E>> lto_elf_syms;
+
   u64 num_dynrel = 0;
   u64 reldyn_offset = 0;
 
@@ -1016,6 +1140,7 @@ public:
   u64 num_global_symtab = 0;
   u64 strtab_offset = 0;
   u64 strtab_size = 0;
+  std::vector<StrtabEntry *> strtab_entries;
   u64 fde_idx = 0;
   u64 fde_offset = 0;
   u64 fde_size = 0;
@@ -1043,6 +1168,13 @@ private:
   std::string_view symbol_strtab;
   const ElfShdr<E> *symtab_sec;
   std::span<u32> symtab_shndx_sec;
+
+  // Objects owned by this file are allocated from these arenas rather
+  // than individually from the heap, as we may have tens of millions
+  // of sections in total.
+  Arena<InputSection<E>> section_arena;
+  Arena<MergeableSection<E>> mergeable_arena;
+  Arena<ElfShdr<E>> shdr_arena;
 };
 
 // SharedFile represents an input .so file.
@@ -1158,6 +1290,29 @@ void gc_sections(Context<E> &ctx);
 template <typename E>
 void icf_sections(Context<E> &ctx);
 
+//
+// call-graph-sort.cc
+//
+
+template <typename E>
+void sort_by_call_graph_profile(Context<E> &ctx);
+
+//
+// lto.cc
+//
+
+template <typename E>
+bool is_gcc_lto_obj(Context<E> &ctx, MappedFile<Context<E>> *mf);
+
+template <typename E>
+ObjectFile<E> *read_lto_object(Context<E> &ctx, MappedFile<Context<E>> *mf);
+
+template <typename E>
+void do_lto(Context<E> &ctx);
+
+template <typename E>
+void lto_cleanup(Context<E> &ctx);
+
 //
 // relocatable.cc
 //
@@ -1223,12 +1378,17 @@ template <typename E> ObjectFile<E> *create_internal_file(Context<E> &);
 template <typename E> void check_cet_errors(Context<E> &);
 template <typename E> void check_duplicate_symbols(Context<E> &);
 template <typename E> void sort_init_fini(Context<E> &);
+template <typename E> void sort_by_symbol_ordering_file(Context<E> &);
+template <typename E>
+void sort_output_section_members(Context<E> &,
+                                 std::unordered_map<InputSection<E> *, i64> &);
 template <typename E> std::vector<Chunk<E> *>
 collect_output_sections(Context<E> &);
 template <typename E> void compute_section_sizes(Context<E> &);
 template <typename E> void claim_unresolved_symbols(Context<E> &);
 template <typename E> void scan_rels(Context<E> &);
 template <typename E> void construct_relr(Context<E> &);
+template <typename E> void construct_android_relocs(Context<E> &);
 template <typename E> void apply_version_script(Context<E> &);
 template <typename E> void parse_symbol_version(Context<E> &);
 template <typename E> void compute_import_export(Context<E> &);
@@ -1237,6 +1397,7 @@ template <typename E> i64 get_section_rank(Context<E> &, Chunk<E> *chunk);
 template <typename E> i64 set_osec_offsets(Context<E> &);
 template <typename E> void fix_synthetic_symbols(Context<E> &);
 template <typename E> void compress_debug_sections(Context<E> &);
+template <typename E> void compute_symbol_addrs(Context<E> &);
 
 //
 // arch-arm64.cc
@@ -1258,6 +1419,12 @@ public:
   virtual void close(Context<E> &ctx) = 0;
   virtual ~OutputFile() {}
 
+  // If the output is not a regular file, contents can be written out
+  // as soon as all chunks before a given file offset are complete.
+  // These are no-ops for regular files.
+  virtual void start_streaming(Context<E> &ctx) {}
+  virtual void notify_chunk_done(Context<E> &ctx, Chunk<E> *chunk) {}
+
   u8 *buf = nullptr;
   std::string path;
   i64 filesize;
@@ -1290,6 +1457,8 @@ typedef enum {
   UNRESOLVED_IGNORE,
 } UnresolvedKind;
 
+typedef enum { MAP_TEXT, MAP_JSON, MAP_CSV } MapFormat;
+
 typedef enum {
   SEPARATE_LOADABLE_SEGMENTS,
   SEPARATE_CODE,
@@ -1354,11 +1523,13 @@ struct Context {
     BuildId build_id;
     CetReportKind z_cet_report = CET_REPORT_NONE;
     CompressKind compress_debug_sections = COMPRESS_NONE;
+    MapFormat Map_format = MAP_TEXT;
     SeparateCodeKind z_separate_code = SEPARATE_LOADABLE_SEGMENTS;
     UnresolvedKind unresolved_symbols = UNRESOLVED_ERROR;
     bool Bsymbolic = false;
     bool Bsymbolic_functions = false;
     bool allow_multiple_definition = false;
+    bool call_graph_profile_sort = true;
     bool color_diagnostics = false;
     bool default_symver = false;
     bool demangle = true;
@@ -1371,9 +1542,12 @@ struct Context {
     bool gc_sections = false;
     bool hash_style_gnu = false;
     bool hash_style_sysv = true;
+    bool huge_pages = false;
     bool icf = false;
+    bool icf_all = false;
     bool is_static = false;
     bool omagic = false;
+    bool pack_dyn_relocs_android = false;
     bool pack_dyn_relocs_relr = false;
     bool perf = false;
     bool pic = false;
@@ -1386,12 +1560,14 @@ struct Context {
     bool relax = true;
     bool relocatable = false;
     bool repro = false;
+    bool reuse_output = false;
     bool shared = false;
     bool stats = false;
     bool strip_all = false;
     bool strip_debug = false;
     bool trace = false;
     bool warn_common = false;
+    bool warn_symbol_ordering = true;
     bool z_copyreloc = true;
     bool z_defs = false;
     bool z_delete = true;
@@ -1411,6 +1587,7 @@ struct Context {
     bool z_text = false;
     i64 emulation = -1;
     i64 filler = -1;
+    i64 optimize = 1;
     i64 spare_dynamic_tags = 5;
     i64 thread_count = 0;
     std::optional<GlobPattern> unique;
@@ -1422,17 +1599,20 @@ struct Context {
     std::string fini = "_fini";
     std::string init = "_init";
     std::string output;
+    std::string plugin;
     std::string rpaths;
     std::string soname;
     std::string sysroot;
     std::unique_ptr<std::unordered_set<std::string_view>> retain_symbols_file;
     std::unordered_set<std::string_view> wrap;
     std::vector<std::pair<std::string_view, std::string_view>> defsyms;
+    std::vector<std::string_view> symbol_ordering_file;
     std::vector<std::string> library_paths;
     std::vector<std::string> version_definitions;
     std::vector<std::string_view> auxiliary;
     std::vector<std::string_view> exclude_libs;
     std::vector<std::string_view> filter;
+    std::vector<std::string_view> plugin_opt;
     std::vector<std::string_view> require_defined;
     std::vector<std::string_view> trace_symbol;
     std::vector<std::string_view> undefined;
@@ -1455,7 +1635,7 @@ struct Context {
   tbb::task_group tg;
 
   bool has_error = false;
-  bool llvm_lto = false;
+  bool has_lto_object = false;
 
   // Symbol table
   tbb::concurrent_hash_map<std::string_view, Symbol<E>> symbol_map;
@@ -1472,7 +1652,6 @@ struct Context {
   tbb::concurrent_vector<std::unique_ptr<ObjectFile<E>>> obj_pool;
   tbb::concurrent_vector<std::unique_ptr<SharedFile<E>>> dso_pool;
   tbb::concurrent_vector<std::unique_ptr<u8[]>> string_pool;
-  tbb::concurrent_vector<std::unique_ptr<ElfShdr<E>>> shdr_pool;
   tbb::concurrent_vector<std::unique_ptr<MappedFile<Context<E>>>> mf_pool;
 
   // Symbol auxiliary data
@@ -1504,6 +1683,7 @@ struct Context {
   std::unique_ptr<RelPltSection<E>> relplt;
   std::unique_ptr<RelDynSection<E>> reldyn;
   std::unique_ptr<RelrDynSection<E>> relrdyn;
+  std::unique_ptr<AndroidRelDynSection<E>> android_reldyn;
   std::unique_ptr<DynamicSection<E>> dynamic;
   std::unique_ptr<StrtabSection<E>> strtab;
   std::unique_ptr<DynstrSection<E>> dynstr;
@@ -1586,7 +1766,6 @@ enum {
   NEEDS_TLSLD    = 1 << 4,
   NEEDS_COPYREL  = 1 << 5,
   NEEDS_TLSDESC  = 1 << 6,
-  NEEDS_THUNK    = 1 << 7,
 };
 
 // Symbol class represents a defined symbol.
@@ -1660,10 +1839,6 @@ public:
   u16 shndx = 0;
   u16 ver_idx = 0;
 
-  // For range extension thunks
-  i32 thunk_idx = -1;
-  i32 thunk_sym_idx = -1;
-
   // `flags` has NEEDS_ flags.
   std::atomic_uint8_t flags = 0;
 
@@ -1677,6 +1852,10 @@ public:
   u8 has_copyrel : 1 = false;
   u8 copyrel_readonly : 1 = false;
 
+  // True if a non-IR file refers to this symbol. Used to tell the LTO
+  // plugin which IR definitions must be kept.
+  u8 referenced_by_regular_obj : 1 = false;
+
   // If a symbol can be interposed at runtime, `is_imported` is true.
   // If a symbol is a dynamic symbol and can be used by other ELF
   // module at runtime, `is_exported` is true.
@@ -1738,9 +1917,20 @@ operator<<(std::ostream &out, const InputSection<E> &isec) {
   return out;
 }
 
+template <typename E>
+inline SectionFragment<E>::SectionFragment(MergedSection<E> *sec)
+  : output_section_idx(sec->idx) {}
+
+template <typename E>
+inline MergedSection<E> &
+SectionFragment<E>::get_output_section(Context<E> &ctx) const {
+  return *ctx.merged_sections[output_section_idx];
+}
+
 template <typename E>
 inline u64 SectionFragment<E>::get_addr(Context<E> &ctx) const {
-  return output_section.shdr.sh_addr + offset;
+  MergedSection<E> &sec = get_output_section(ctx);
+  return sec.shdr.sh_addr + sec.shard_offsets[shard_idx] + offset;
 }
 
 template <typename E>
@@ -1752,7 +1942,19 @@ inline void InputSection<E>::kill() {
 
 template <typename E>
 inline u64 InputSection<E>::get_addr() const {
-  return output_section->shdr.sh_addr + offset;
+  return output_section->shdr.sh_addr + get_offset();
+}
+
+template <typename E>
+inline u64 InputSection<E>::get_offset() const {
+  return ((u64)offset_hi << 32) | offset_lo;
+}
+
+template <typename E>
+inline void InputSection<E>::set_offset(u64 offset) {
+  assert(offset < ((u64)1 << 48));
+  offset_lo = offset;
+  offset_hi = offset >> 32;
 }
 
 template <typename E>
@@ -1827,8 +2029,7 @@ InputSection<E>::get_fragment(Context<E> &ctx, const ElfRel<E> &rel) {
   if (esym.st_type != STT_SECTION)
     return {nullptr, 0};
 
-  std::unique_ptr<MergeableSection<E>> &m =
-    file.mergeable_sections[file.get_shndx(esym)];
+  MergeableSection<E> *m = file.mergeable_sections[file.get_shndx(esym)];
   if (!m)
     return {nullptr, 0};
 
@@ -1908,7 +2109,7 @@ inline i64 ObjectFile<E>::get_shndx(const ElfSym<E> &esym) {
 
 template <typename E>
 inline InputSection<E> *ObjectFile<E>::get_section(const ElfSym<E> &esym) {
-  return sections[get_shndx(esym)].get();
+  return sections[get_shndx(esym)];
 }
 
 // This operator defines a total order over symbols. This is used to
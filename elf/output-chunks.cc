@@ -376,13 +376,328 @@ void RelrDynSection<E>::copy_buf(Context<E> &ctx) {
       *buf++ = (val & 1) ? val : (osec->shdr.sh_addr + val);
 }
 
+// The Android packed relocation format (APS2) is a sequence of signed
+// LEB128 values. It starts with "APS2", the number of relocations and
+// the initial offset, followed by groups of relocations. Each group
+// has a header telling which fields are shared by all relocations in
+// the group. Offsets and addends are encoded as deltas from the
+// previous relocation's.
+enum {
+  RELOCATION_GROUPED_BY_INFO_FLAG = 1,
+  RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG = 2,
+  RELOCATION_GROUPED_BY_ADDEND_FLAG = 4,
+  RELOCATION_GROUP_HAS_ADDEND_FLAG = 8,
+};
+
+struct AndroidRel {
+  u64 offset;
+  u64 info;
+  i64 addend;
+};
+
+template <typename E>
+static constexpr i64 PADDED_SLEB_SIZE = (E::word_size == 8) ? 10 : 5;
+
+template <typename E>
+static u64 android_rel_info(u32 type, u32 sym) {
+  if constexpr (E::word_size == 8)
+    return ((u64)sym << 32) | type;
+  else
+    return (sym << 8) | type;
+}
+
+template <typename E>
+static AndroidRelocs encode_android_relocs(std::vector<AndroidRel> &rels) {
+  AndroidRelocs out;
+  if (rels.empty())
+    return out;
+
+  tbb::parallel_sort(rels.begin(), rels.end(),
+                     [](const AndroidRel &a, const AndroidRel &b) {
+    return a.offset < b.offset;
+  });
+
+  std::vector<u8> &buf = out.buf;
+  out.num_relocs = rels.size();
+  out.first_offset = rels[0].offset;
+  out.first_addend = rels[0].addend;
+
+  // The first relocation forms a group by itself. Its offset delta and
+  // addend are relative to the previous section's last relocation, so
+  // we leave placeholders for them.
+  encode_sleb(buf, 1);
+  if constexpr (E::is_rel) {
+    encode_sleb(buf, RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG |
+                     RELOCATION_GROUPED_BY_INFO_FLAG);
+  } else {
+    encode_sleb(buf, RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG |
+                     RELOCATION_GROUPED_BY_INFO_FLAG |
+                     RELOCATION_GROUP_HAS_ADDEND_FLAG |
+                     RELOCATION_GROUPED_BY_ADDEND_FLAG);
+  }
+
+  out.offset_pos = buf.size();
+  buf.resize(buf.size() + PADDED_SLEB_SIZE<E>);
+  encode_sleb(buf, rels[0].info);
+
+  if constexpr (!E::is_rel) {
+    out.addend_pos = buf.size();
+    buf.resize(buf.size() + PADDED_SLEB_SIZE<E>);
+  }
+
+  u64 offset = rels[0].offset;
+  i64 addend = rels[0].addend;
+
+  // Returns the end of a run of relocations that start at `i` and
+  // are placed at the same interval.
+  auto get_run_end = [&](i64 i) {
+    u64 delta = rels[i].offset - rels[i - 1].offset;
+    i64 j = i + 1;
+    while (j < rels.size() && rels[j].offset - rels[j - 1].offset == delta)
+      j++;
+    return j;
+  };
+
+  // Three or more relocations at the same interval form a group whose
+  // members' offsets are not encoded individually. Other relocations
+  // are put into groups with individual offsets.
+  for (i64 i = 1; i < rels.size();) {
+    i64 end = get_run_end(i);
+    bool by_delta = (end - i >= 3);
+
+    if (!by_delta) {
+      end = i + 1;
+      while (end < rels.size() && get_run_end(end) - end < 3)
+        end++;
+    }
+
+    std::span<AndroidRel> group(rels.data() + i, rels.data() + end);
+
+    bool by_info = true;
+    bool by_addend = true;
+    bool has_addend = false;
+
+    for (AndroidRel &rel : group) {
+      by_info = by_info && rel.info == group[0].info;
+      by_addend = by_addend && rel.addend == group[0].addend;
+      has_addend = has_addend || rel.addend;
+    }
+
+    if constexpr (E::is_rel)
+      has_addend = false;
+
+    i64 flags = 0;
+    if (by_info)
+      flags |= RELOCATION_GROUPED_BY_INFO_FLAG;
+    if (by_delta)
+      flags |= RELOCATION_GROUPED_BY_OFFSET_DELTA_FLAG;
+    if (has_addend)
+      flags |= RELOCATION_GROUP_HAS_ADDEND_FLAG;
+    if (has_addend && by_addend)
+      flags |= RELOCATION_GROUPED_BY_ADDEND_FLAG;
+
+    encode_sleb(buf, group.size());
+    encode_sleb(buf, flags);
+    if (by_delta)
+      encode_sleb(buf, group[0].offset - offset);
+    if (by_info)
+      encode_sleb(buf, group[0].info);
+
+    if (!has_addend) {
+      addend = 0;
+    } else if (by_addend) {
+      encode_sleb(buf, group[0].addend - addend);
+      addend = group[0].addend;
+    }
+
+    for (AndroidRel &rel : group) {
+      if (!by_delta)
+        encode_sleb(buf, rel.offset - offset);
+      if (!by_info)
+        encode_sleb(buf, rel.info);
+      if (has_addend && !by_addend) {
+        encode_sleb(buf, rel.addend - addend);
+        addend = rel.addend;
+      }
+      offset = rel.offset;
+    }
+
+    i = end;
+  }
+
+  out.last_offset = offset;
+  out.last_addend = addend;
+  return out;
+}
+
+template <typename E>
+static std::vector<std::pair<Chunk<E> *, AndroidRelocs *>>
+get_android_relocs(Context<E> &ctx) {
+  std::vector<std::pair<Chunk<E> *, AndroidRelocs *>> vec;
+
+  if (ctx.got->android_relocs.num_relocs)
+    vec.push_back({ctx.got.get(), &ctx.got->android_relocs});
+
+  for (std::unique_ptr<OutputSection<E>> &osec : ctx.output_sections)
+    if (osec->android_relocs.num_relocs)
+      vec.push_back({osec.get(), &osec->android_relocs});
+
+  sort(vec, [](const std::pair<Chunk<E> *, AndroidRelocs *> &a,
+               const std::pair<Chunk<E> *, AndroidRelocs *> &b) {
+    return a.first->shdr.sh_addr < b.first->shdr.sh_addr;
+  });
+  return vec;
+}
+
+static std::vector<u8> get_android_reldyn_header(i64 num_relocs) {
+  std::vector<u8> buf = {'A', 'P', 'S', '2'};
+  encode_sleb(buf, num_relocs);
+  encode_sleb(buf, 0);
+  return buf;
+}
+
+template <typename E>
+void AndroidRelDynSection<E>::update_shdr(Context<E> &ctx) {
+  this->shdr.sh_link = ctx.dynsym->shndx;
+
+  i64 num_relocs = 0;
+  i64 size = 0;
+
+  for (std::pair<Chunk<E> *, AndroidRelocs *> p : get_android_relocs(ctx)) {
+    num_relocs += p.second->num_relocs;
+    size += p.second->buf.size();
+  }
+
+  if (num_relocs)
+    size += get_android_reldyn_header(num_relocs).size();
+  this->shdr.sh_size = size;
+}
+
 template <typename E>
-void StrtabSection<E>::update_shdr(Context<E> &ctx) {
+void AndroidRelDynSection<E>::copy_buf(Context<E> &ctx) {
+  std::vector<std::pair<Chunk<E> *, AndroidRelocs *>> vec =
+    get_android_relocs(ctx);
+
+  i64 num_relocs = 0;
+  for (std::pair<Chunk<E> *, AndroidRelocs *> p : vec)
+    num_relocs += p.second->num_relocs;
+
+  u8 *buf = ctx.buf + this->shdr.sh_offset;
+  buf += write_vector(buf, get_android_reldyn_header(num_relocs));
+
+  // Copy each section's relocations while filling the placeholders
+  // with deltas from the previous section's last relocation.
+  u64 offset = 0;
+  i64 addend = 0;
+
+  for (auto [chunk, rels] : vec) {
+    u64 addr = chunk->shdr.sh_addr;
+    memcpy(buf, rels->buf.data(), rels->buf.size());
+    write_padded_sleb(buf + rels->offset_pos,
+                      addr + rels->first_offset - offset, PADDED_SLEB_SIZE<E>);
+    if (rels->addend_pos != -1)
+      write_padded_sleb(buf + rels->addend_pos,
+                        rels->first_addend - addend, PADDED_SLEB_SIZE<E>);
+
+    offset = addr + rels->last_offset;
+    addend = rels->last_addend;
+    buf += rels->buf.size();
+  }
+}
+
+// Many symbol names appear in more than one file. For example, static
+// functions or C++ inline functions often have the same name in
+// different translation units. We write each unique name only once.
+//
+// To make the output deterministic, a string is owned by the first
+// symbol that refers to it in the order of input files, and the string
+// is placed in the owner file's portion of .strtab. If no string is
+// shared, the result is the same as concatenating each file's symbol
+// names.
+template <typename E>
+void StrtabSection<E>::construct(Context<E> &ctx) {
+  i64 num_syms = 0;
+  for (ObjectFile<E> *file : ctx.objs)
+    num_syms += file->num_local_symtab + file->num_global_symtab;
+
   this->shdr.sh_size = 1;
+  if (num_syms == 0)
+    return;
+
+  map.resize(num_syms * 3 / 2);
+
+  // Insert symbol names to the map in the order of write_symtab().
+  std::vector<i64> orig_sizes(ctx.objs.size());
+
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    ObjectFile<E> &file = *ctx.objs[i];
+    file.strtab_entries.clear();
+    file.strtab_entries.reserve(file.num_local_symtab + file.num_global_symtab);
+
+    auto add = [&](Symbol<E> &sym) {
+      std::string_view name = sym.name();
+      if (name.empty()) {
+        file.strtab_entries.push_back(nullptr);
+        return;
+      }
+
+      StrtabEntry *ent =
+        map.insert(name, hash_string(name), StrtabEntry()).first;
+      update_minimum(ent->owner, (i << 32) | file.strtab_entries.size());
+      file.strtab_entries.push_back(ent);
+      orig_sizes[i] += name.size() + 1;
+    };
+
+    for (i64 j = 1; j < file.first_global; j++)
+      if (Symbol<E> &sym = *file.symbols[j]; sym.write_to_symtab)
+        add(sym);
+
+    for (i64 j = file.first_global; j < file.elf_syms.size(); j++)
+      if (Symbol<E> &sym = *file.symbols[j];
+          sym.file == &file && sym.write_to_symtab)
+        add(sym);
+  });
+
+  // Compute the size of strings owned by each file.
+  auto is_owner = [](i64 i, i64 j, StrtabEntry *ent) {
+    return ent && ent->owner == ((i << 32) | j);
+  };
+
+  auto get_size = [&](StrtabEntry *ent) {
+    return map.sizes[ent - map.values] + 1;
+  };
+
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    ObjectFile<E> &file = *ctx.objs[i];
+    file.strtab_size = 0;
+    for (i64 j = 0; j < file.strtab_entries.size(); j++)
+      if (StrtabEntry *ent = file.strtab_entries[j]; is_owner(i, j, ent))
+        file.strtab_size += get_size(ent);
+  });
+
   for (ObjectFile<E> *file : ctx.objs) {
     file->strtab_offset = this->shdr.sh_size;
     this->shdr.sh_size += file->strtab_size;
   }
+
+  // Assign offsets to strings.
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    ObjectFile<E> &file = *ctx.objs[i];
+    i64 offset = file.strtab_offset;
+    for (i64 j = 0; j < file.strtab_entries.size(); j++) {
+      if (StrtabEntry *ent = file.strtab_entries[j]; is_owner(i, j, ent)) {
+        ent->offset = offset;
+        offset += get_size(ent);
+      }
+    }
+  });
+
+  i64 orig_size = 1;
+  for (i64 size : orig_sizes)
+    orig_size += size;
+
+  static Counter saved("strtab_saved_bytes");
+  saved += orig_size - this->shdr.sh_size;
 }
 
 template <typename E>
@@ -434,14 +749,12 @@ void DynstrSection<E>::copy_buf(Context<E> &ctx) {
   for (std::pair<std::string_view, i64> pair : strings)
     write_string(base + pair.second, pair.first);
 
-  if (!ctx.dynsym->symbols.empty()) {
-    i64 offset = dynsym_offset;
-    for (Symbol<E> *sym :
-           std::span<Symbol<E> *>(ctx.dynsym->symbols).subspan(1)) {
-      write_string(base + offset, sym->name());
-      offset += sym->name().size() + 1;
-    }
-  }
+  std::vector<Symbol<E> *> &syms = ctx.dynsym->symbols;
+  std::vector<u32> &offsets = ctx.dynsym->name_offsets;
+
+  tbb::parallel_for((i64)1, (i64)syms.size(), [&](i64 i) {
+    write_string(base + offsets[i], syms[i]->name());
+  });
 }
 
 template <typename E>
@@ -524,6 +837,13 @@ static std::vector<typename E::WordTy> create_dynamic_section(Context<E> &ctx) {
     define(E::is_rel ? DT_RELENT : DT_RELAENT, sizeof(ElfRel<E>));
   }
 
+  if (ctx.android_reldyn && ctx.android_reldyn->shdr.sh_size) {
+    define(E::is_rel ? DT_ANDROID_REL : DT_ANDROID_RELA,
+           ctx.android_reldyn->shdr.sh_addr);
+    define(E::is_rel ? DT_ANDROID_RELSZ : DT_ANDROID_RELASZ,
+           ctx.android_reldyn->shdr.sh_size);
+  }
+
   if (ctx.relplt->shdr.sh_size) {
     define(DT_JMPREL, ctx.relplt->shdr.sh_addr);
     define(DT_PLTRELSZ, ctx.relplt->shdr.sh_size);
@@ -770,6 +1090,17 @@ OutputSection<E>::get_instance(Context<E> &ctx, std::string_view name,
   return osec;
 }
 
+template <typename E>
+void OutputSection<E>::update_member_attrs() {
+  member_sizes.resize(members.size());
+  member_p2aligns.resize(members.size());
+
+  tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
+    member_sizes[i] = members[i]->shdr.sh_size;
+    member_p2aligns[i] = to_p2align(members[i]->shdr.sh_addralign);
+  });
+}
+
 template <typename E>
 void OutputSection<E>::copy_buf(Context<E> &ctx) {
   if (this->shdr.sh_type != SHT_NOBITS)
@@ -781,12 +1112,12 @@ void OutputSection<E>::write_to(Context<E> &ctx, u8 *buf) {
   tbb::parallel_for((i64)0, (i64)members.size(), [&](i64 i) {
     // Copy section contents to an output file
     InputSection<E> &isec = *members[i];
-    isec.write_to(ctx, buf + isec.offset);
+    isec.write_to(ctx, buf + isec.get_offset());
 
     // Zero-clear trailing padding
-    u64 this_end = isec.offset + isec.shdr.sh_size;
+    u64 this_end = isec.get_offset() + isec.shdr.sh_size;
     u64 next_start = (i == members.size() - 1) ?
-      this->shdr.sh_size : members[i + 1]->offset;
+      this->shdr.sh_size : members[i + 1]->get_offset();
     memset(buf + this_end, 0, next_start - this_end);
   });
 }
@@ -859,7 +1190,7 @@ void OutputSection<E>::construct_relr(Context<E> &ctx) {
 
     for (i64 i = 0; i < rels.size(); i++)
       if (isec->needs_baserel[i] && (rels[i].r_offset % E::word_size) == 0)
-        vec.push_back(isec->offset + rels[i].r_offset);
+        vec.push_back(isec->get_offset() + rels[i].r_offset);
 
     if (!vec.empty()) {
       std::scoped_lock lock(mu);
@@ -874,41 +1205,34 @@ void OutputSection<E>::construct_relr(Context<E> &ctx) {
 }
 
 template <typename E>
-void GotSection<E>::add_got_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->set_got_idx(ctx, this->shdr.sh_size / E::word_size);
-  this->shdr.sh_size += E::word_size;
-  got_syms.push_back(sym);
-}
+void OutputSection<E>::construct_android_relocs(Context<E> &ctx) {
+  if (!(this->shdr.sh_flags & SHF_ALLOC))
+    return;
 
-template <typename E>
-void GotSection<E>::add_gottp_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->set_gottp_idx(ctx, this->shdr.sh_size / E::word_size);
-  this->shdr.sh_size += E::word_size;
-  gottp_syms.push_back(sym);
-}
+  // Collect dynamic relocations against imported symbols
+  std::vector<AndroidRel> rels;
+  std::mutex mu;
 
-template <typename E>
-void GotSection<E>::add_tlsgd_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->set_tlsgd_idx(ctx, this->shdr.sh_size / E::word_size);
-  this->shdr.sh_size += E::word_size * 2;
-  tlsgd_syms.push_back(sym);
-  ctx.dynsym->add_symbol(ctx, sym);
-}
+  tbb::parallel_for_each(members, [&](InputSection<E> *isec) {
+    std::span<ElfRel<E>> rels2 = isec->get_rels(ctx);
+    std::vector<AndroidRel> vec;
+
+    for (i64 i = 0; i < rels2.size(); i++) {
+      if (isec->needs_dynrel[i]) {
+        Symbol<E> &sym = *isec->file.symbols[rels2[i].r_sym];
+        vec.push_back({isec->get_offset() + rels2[i].r_offset,
+                       android_rel_info<E>(E::R_ABS, sym.get_dynsym_idx(ctx)),
+                       isec->get_addend(rels2[i])});
+      }
+    }
 
-template <typename E>
-void GotSection<E>::add_tlsdesc_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  sym->set_tlsdesc_idx(ctx, this->shdr.sh_size / E::word_size);
-  this->shdr.sh_size += E::word_size * 2;
-  tlsdesc_syms.push_back(sym);
-  ctx.dynsym->add_symbol(ctx, sym);
-}
+    if (!vec.empty()) {
+      std::scoped_lock lock(mu);
+      append(rels, vec);
+    }
+  });
 
-template <typename E>
-void GotSection<E>::add_tlsld(Context<E> &ctx) {
-  if (tlsld_idx != -1)
-    return;
-  tlsld_idx = this->shdr.sh_size / E::word_size;
-  this->shdr.sh_size += E::word_size * 2;
+  android_relocs = encode_android_relocs<E>(rels);
 }
 
 template <typename E>
@@ -921,9 +1245,9 @@ template <typename E>
 i64 GotSection<E>::get_reldyn_size(Context<E> &ctx) const {
   i64 n = 0;
   for (Symbol<E> *sym : got_syms)
-    if (sym->is_imported ||
-        sym->get_type() == STT_GNU_IFUNC ||
-        (ctx.arg.pic && sym->is_relative() && !ctx.arg.pack_dyn_relocs_relr))
+    if (sym->is_imported ? !ctx.arg.pack_dyn_relocs_android :
+        (sym->get_type() == STT_GNU_IFUNC ||
+         (ctx.arg.pic && sym->is_relative() && !ctx.arg.pack_dyn_relocs_relr)))
       n++;
 
   n += tlsgd_syms.size() * 2;
@@ -952,7 +1276,8 @@ void GotSection<E>::copy_buf(Context<E> &ctx) {
   for (Symbol<E> *sym : got_syms) {
     u64 addr = sym->get_got_addr(ctx);
     if (sym->is_imported) {
-      *rel++ = reloc<E>(addr, E::R_GLOB_DAT, sym->get_dynsym_idx(ctx));
+      if (!ctx.arg.pack_dyn_relocs_android)
+        *rel++ = reloc<E>(addr, E::R_GLOB_DAT, sym->get_dynsym_idx(ctx));
     } else if (sym->get_type() == STT_GNU_IFUNC) {
       u64 resolver_addr = sym->input_section->get_addr() + sym->value;
       *rel++ = reloc<E>(addr, E::R_IRELATIVE, 0, resolver_addr);
@@ -1008,32 +1333,17 @@ void GotSection<E>::construct_relr(Context<E> &ctx) {
 }
 
 template <typename E>
-void PltSection<E>::add_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  assert(!sym->has_plt(ctx));
-
-  if (this->shdr.sh_size == 0) {
-    this->shdr.sh_size = ctx.plt_hdr_size;
-    ctx.gotplt->shdr.sh_size = E::word_size * 3;
-  }
+void GotSection<E>::construct_android_relocs(Context<E> &ctx) {
+  std::vector<AndroidRel> rels;
 
-  sym->set_plt_idx(ctx, symbols.size());
-  this->shdr.sh_size += ctx.plt_size;
-  symbols.push_back(sym);
-
-  sym->set_gotplt_idx(ctx, ctx.gotplt->shdr.sh_size / E::word_size);
-  ctx.gotplt->shdr.sh_size += E::word_size;
-  ctx.relplt->shdr.sh_size += sizeof(ElfRel<E>);
-  ctx.dynsym->add_symbol(ctx, sym);
-}
-
-template <typename E>
-void PltGotSection<E>::add_symbol(Context<E> &ctx, Symbol<E> *sym) {
-  assert(!sym->has_plt(ctx));
-  assert(sym->has_got(ctx));
+  for (Symbol<E> *sym : got_syms)
+    if (sym->is_imported)
+      rels.push_back({sym->get_got_idx(ctx) * E::word_size,
+                      android_rel_info<E>(E::R_GLOB_DAT,
+                                          sym->get_dynsym_idx(ctx)),
+                      0});
 
-  sym->set_pltgot_idx(ctx, this->shdr.sh_size / E::pltgot_size);
-  this->shdr.sh_size += E::pltgot_size;
-  symbols.push_back(sym);
+  android_relocs = encode_android_relocs<E>(rels);
 }
 
 template <typename E>
@@ -1064,65 +1374,79 @@ template <typename E>
 void DynsymSection<E>::finalize(Context<E> &ctx) {
   Timer t(ctx, "DynsymSection::finalize");
 
-  auto is_local = [](Symbol<E> *sym) {
-    return !sym->is_imported && !sym->is_exported;
-  };
-
   // In any symtab, local symbols must precede global symbols.
   // We also place undefined symbols before defined symbols for .gnu.hash.
-  sort(symbols.begin() + 1, symbols.end(), [&](Symbol<E> *a, Symbol<E> *b) {
-    if (auto x = (is_local(a) <=> is_local(b)); x != 0)
-      return x > 0;
-    return a->is_exported < b->is_exported;
-  });
+  // If we have .gnu.hash section, we also need to sort exported symbols
+  // by their hash buckets.
+  //
+  // We need a stable sort for build reproducibility, but parallel_sort
+  // isn't stable, so we use this struct to make it stable.
+  struct T {
+    Symbol<E> *sym;
+    u32 rank;
+    u32 hash;
+    u32 bucket;
+    i32 idx;
+  };
 
-  auto first_global = std::partition_point(symbols.begin() + 1, symbols.end(),
-                                           is_local);
+  std::vector<T> vec(symbols.size() - 1);
 
-  // If we have .gnu.hash section, we need to sort .dynsym contents by
-  // symbol hashes.
-  if (ctx.gnu_hash) {
-    // We need a stable sort for build reproducibility, but parallel_sort
-    // isn't stable, so we use this struct to make it stable.
-    struct T {
-      Symbol<E> *sym;
-      u32 hash;
-      i32 idx;
-    };
-
-    auto first_exported = std::partition_point(
-      first_global, symbols.end(), [](Symbol<E> *x) { return !x->is_exported; });
+  tbb::parallel_for((i64)1, (i64)symbols.size(), [&](i64 i) {
+    Symbol<E> *sym = symbols[i];
+    u32 rank = (!sym->is_imported && !sym->is_exported) ? 0 :
+               !sym->is_exported ? 1 : 2;
+    vec[i - 1] = {sym, rank, 0, 0, (i32)i};
+  });
 
-    i64 base_offset = first_exported - symbols.begin();
-    i64 num_exported = symbols.end() - first_exported;
+  i64 num_locals = 0;
+  i64 num_exported = 0;
+  for (T &x : vec) {
+    if (x.rank == 0)
+      num_locals++;
+    else if (x.rank == 2)
+      num_exported++;
+  }
 
-    std::vector<T> vec(num_exported);
-    ctx.gnu_hash->num_buckets = num_exported / ctx.gnu_hash->LOAD_FACTOR + 1;
+  // Hash values are saved so that GnuHashSection doesn't have to
+  // compute them again.
+  if (ctx.gnu_hash) {
+    u32 num_buckets = num_exported / ctx.gnu_hash->LOAD_FACTOR + 1;
+    ctx.gnu_hash->num_buckets = num_buckets;
 
-    tbb::parallel_for((i64)0, num_exported, [&](i64 i) {
-      Symbol<E> *sym = symbols[base_offset + i];
-      vec[i].sym = sym;
-      vec[i].hash = djb_hash(sym->name()) % ctx.gnu_hash->num_buckets;
-      vec[i].idx = i;
+    tbb::parallel_for_each(vec, [&](T &x) {
+      if (x.rank == 2) {
+        x.hash = djb_hash(x.sym->name());
+        x.bucket = x.hash % num_buckets;
+      }
     });
+  }
 
-    tbb::parallel_sort(vec.begin(), vec.end(), [&](const T &a, const T &b) {
-      return std::tuple(a.hash, a.idx) < std::tuple(b.hash, b.idx);
-    });
+  tbb::parallel_sort(vec.begin(), vec.end(), [](const T &a, const T &b) {
+    return std::tuple(a.rank, a.bucket, a.idx) <
+           std::tuple(b.rank, b.bucket, b.idx);
+  });
 
-    for (i64 i = 0; i < num_exported; i++)
-      symbols[base_offset + i] = vec[i].sym;
-  }
+  i64 first_exported = symbols.size() - num_exported;
+  if (ctx.gnu_hash)
+    ctx.gnu_hash->hashes.resize(num_exported);
+
+  tbb::parallel_for((i64)0, (i64)vec.size(), [&](i64 i) {
+    symbols[i + 1] = vec[i].sym;
+    vec[i].sym->set_dynsym_idx(ctx, i + 1);
+    if (ctx.gnu_hash && i + 1 >= first_exported)
+      ctx.gnu_hash->hashes[i + 1 - first_exported] = vec[i].hash;
+  });
 
-  ctx.dynstr->dynsym_offset = ctx.dynstr->shdr.sh_size;
+  // Assign .dynstr offsets to symbol names.
+  name_offsets.resize(symbols.size());
 
   for (i64 i = 1; i < symbols.size(); i++) {
-    symbols[i]->set_dynsym_idx(ctx, i);
+    name_offsets[i] = ctx.dynstr->shdr.sh_size;
     ctx.dynstr->shdr.sh_size += symbols[i]->name().size() + 1;
   }
 
   // ELF's symbol table sh_info holds the offset of the first global symbol.
-  this->shdr.sh_info = first_global - symbols.begin();
+  this->shdr.sh_info = num_locals + 1;
 }
 
 template <typename E>
@@ -1135,9 +1459,8 @@ template <typename E>
 void DynsymSection<E>::copy_buf(Context<E> &ctx) {
   u8 *base = ctx.buf + this->shdr.sh_offset;
   memset(base, 0, sizeof(ElfSym<E>));
-  i64 name_offset = ctx.dynstr->dynsym_offset;
 
-  for (i64 i = 1; i < symbols.size(); i++) {
+  tbb::parallel_for((i64)1, (i64)symbols.size(), [&](i64 i) {
     Symbol<E> &sym = *symbols[i];
     ElfSym<E> &esym =
       *(ElfSym<E> *)(base + sym.get_dynsym_idx(ctx) * sizeof(ElfSym<E>));
@@ -1155,8 +1478,7 @@ void DynsymSection<E>::copy_buf(Context<E> &ctx) {
     else
       esym.st_bind = sym.esym().st_bind;
 
-    esym.st_name = name_offset;
-    name_offset += sym.name().size() + 1;
+    esym.st_name = name_offsets[i];
 
     if (sym.has_copyrel) {
       esym.st_shndx = sym.copyrel_readonly
@@ -1180,7 +1502,7 @@ void DynsymSection<E>::copy_buf(Context<E> &ctx) {
       esym.st_value = sym.get_addr(ctx, false);
       esym.st_visibility = sym.visibility;
     }
-  }
+  });
 }
 
 template <typename E>
@@ -1206,11 +1528,14 @@ void HashSection<E>::copy_buf(Context<E> &ctx) {
 
   hdr[0] = hdr[1] = num_slots;
 
-  for (i64 i = 1; i < ctx.dynsym->symbols.size(); i++) {
-    Symbol<E> *sym = ctx.dynsym->symbols[i];
-    i64 idx = elf_hash(sym->name()) % num_slots;
-    chains[sym->get_dynsym_idx(ctx)] = buckets[idx];
-    buckets[idx] = sym->get_dynsym_idx(ctx);
+  std::vector<u32> hashes(num_slots);
+  tbb::parallel_for((i64)1, num_slots, [&](i64 i) {
+    hashes[i] = elf_hash(ctx.dynsym->symbols[i]->name()) % num_slots;
+  });
+
+  for (i64 i = 1; i < num_slots; i++) {
+    chains[i] = buckets[hashes[i]];
+    buckets[hashes[i]] = i;
   }
 }
 
@@ -1257,44 +1582,54 @@ void GnuHashSection<E>::copy_buf(Context<E> &ctx) {
   *(u32 *)(base + 8) = num_bloom;
   *(u32 *)(base + 12) = BLOOM_SHIFT;
 
-  std::vector<u32> hashes(syms.size());
-  for (i64 i = 0; i < syms.size(); i++)
-    hashes[i] = djb_hash(syms[i]->name());
+  // Hash values were computed by DynsymSection::finalize().
+  assert(hashes.size() == syms.size());
+
+  // Write a bloom filter. Each thread sets bits in its own partial
+  // filter, and we merge them at the end.
+  using Word = typename E::WordTy;
 
-  // Write a bloom filter
-  typename E::WordTy *bloom = (typename E::WordTy *)(base + HEADER_SIZE);
-  for (i64 hash : hashes) {
+  tbb::enumerable_thread_specific<std::vector<Word>> partial([&] {
+    return std::vector<Word>(num_bloom);
+  });
+
+  tbb::parallel_for((i64)0, (i64)hashes.size(), [&](i64 i) {
+    std::vector<Word> &bits = partial.local();
+    u32 hash = hashes[i];
     i64 idx = (hash / ELFCLASS_BITS) % num_bloom;
-    bloom[idx] |= (u64)1 << (hash % ELFCLASS_BITS);
-    bloom[idx] |= (u64)1 << ((hash >> BLOOM_SHIFT) % ELFCLASS_BITS);
-  }
+    bits[idx] |= (u64)1 << (hash % ELFCLASS_BITS);
+    bits[idx] |= (u64)1 << ((hash >> BLOOM_SHIFT) % ELFCLASS_BITS);
+  });
+
+  Word *bloom = (Word *)(base + HEADER_SIZE);
+  partial.combine_each([&](std::vector<Word> &bits) {
+    for (i64 i = 0; i < num_bloom; i++)
+      bloom[i] |= bits[i];
+  });
 
-  // Write hash bucket indices
+  // Write hash bucket indices and a hash table. Since symbols are
+  // sorted by bucket, each bucket refers to the first symbol in a run
+  // of symbols with the same bucket, and the last symbol in a run is
+  // marked by the least significant bit of its hash value.
   u32 *buckets = (u32 *)(bloom + num_bloom);
-  for (i64 i = 0; i < hashes.size(); i++) {
+  u32 *table = buckets + num_buckets;
+
+  tbb::parallel_for((i64)0, (i64)hashes.size(), [&](i64 i) {
     i64 idx = hashes[i] % num_buckets;
-    if (!buckets[idx])
+    if (i == 0 || hashes[i - 1] % num_buckets != idx)
       buckets[idx] = i + exported_offset;
-  }
-
-  // Write a hash table
-  u32 *table = buckets + num_buckets;
-  for (i64 i = 0; i < syms.size(); i++) {
-    bool is_last = false;
-    if (i == syms.size() - 1 ||
-        (hashes[i] % num_buckets) != (hashes[i + 1] % num_buckets))
-      is_last = true;
 
-    if (is_last)
+    if (i == hashes.size() - 1 || hashes[i + 1] % num_buckets != idx)
       table[i] = hashes[i] | 1;
     else
       table[i] = hashes[i] & ~1;
-  }
+  });
 }
 
 template <typename E>
-MergedSection<E>::MergedSection(std::string_view name, u64 flags, u32 type)
-  : Chunk<E>(this->SYNTHETIC) {
+MergedSection<E>::MergedSection(std::string_view name, u64 flags, u32 type,
+                                u16 idx)
+  : Chunk<E>(this->SYNTHETIC), idx(idx) {
   this->name = name;
   this->shdr.sh_flags = flags;
   this->shdr.sh_type = type;
@@ -1328,7 +1663,11 @@ MergedSection<E>::get_instance(Context<E> &ctx, std::string_view name,
   if (MergedSection *osec = find())
     return osec;
 
-  auto *osec = new MergedSection(name, flags, type);
+  // SectionFragment refers to its output section with a 12-bit index.
+  if (ctx.merged_sections.size() >= 4096)
+    Fatal(ctx) << "too many mergeable output sections";
+
+  auto *osec = new MergedSection(name, flags, type, ctx.merged_sections.size());
   ctx.merged_sections.push_back(std::unique_ptr<MergedSection>(osec));
   return osec;
 }
@@ -1346,11 +1685,105 @@ MergedSection<E>::insert(std::string_view data, u64 hash, i64 alignment) {
   std::tie(frag, inserted) = map.insert(data, hash, SectionFragment(this));
   assert(frag);
 
-  assert(alignment < UINT16_MAX);
-  update_maximum(frag->alignment, alignment);
+  update_maximum(frag->p2align, to_p2align(alignment));
   return frag;
 }
 
+// If -O2 is given, we merge strings that are suffixes of other strings
+// into the longer ones. For example, "foo" is not emitted if "barfoo"
+// exists; it refers to the last four bytes of "barfoo" (including the
+// terminating null) instead.
+//
+// To find such strings, we sort strings by their reversed contents in
+// descending order. Then a string comes immediately after the strings
+// it is a suffix of, so we only need to compare adjacent strings.
+//
+// This function returns a list of (fragment, fragment it is merged
+// into) pairs as indices into `map`.
+template <typename E>
+std::vector<std::pair<i64, i64>>
+MergedSection<E>::find_tail_merged_strings(Context<E> &ctx) {
+  struct Entry {
+    u64 tail;
+    std::string_view str;
+    i64 idx;
+  };
+
+  // `tail` is the last eight bytes of a string in reverse order, so that
+  // comparing them as integers is the same as comparing reversed strings
+  // as long as they differ in the last eight bytes. This saves us from
+  // chasing string pointers for most comparisons.
+  auto get_tail = [](std::string_view str) {
+    u64 val = 0;
+    for (i64 i = 0; i < 8; i++)
+      val = (val << 8) | (i < str.size() ? (u8)str[str.size() - i - 1] : 0);
+    return val;
+  };
+
+  i64 shard_size = map.nbuckets / map.NUM_SHARDS;
+  std::vector<std::vector<Entry>> vec(map.NUM_SHARDS);
+
+  tbb::parallel_for((i64)0, map.NUM_SHARDS, [&](i64 i) {
+    for (i64 j = shard_size * i; j < shard_size * (i + 1); j++) {
+      if (map.values[j].is_alive) {
+        std::string_view str(map.keys[j], map.sizes[j]);
+        vec[i].push_back({get_tail(str), str, j});
+      }
+    }
+  });
+
+  std::vector<Entry> entries = flatten(vec);
+
+  // Strings are unique, so the result is deterministic.
+  tbb::parallel_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) {
+    if (a.tail != b.tail)
+      return a.tail > b.tail;
+
+    std::string_view x = a.str;
+    std::string_view y = b.str;
+    i64 len = std::min(x.size(), y.size());
+
+    for (i64 i = 9; i <= len; i++) {
+      u8 c1 = x[x.size() - i];
+      u8 c2 = y[y.size() - i];
+      if (c1 != c2)
+        return c1 > c2;
+    }
+    return x.size() > y.size();
+  });
+
+  std::vector<u8> is_suffix(entries.size());
+  tbb::parallel_for((i64)1, (i64)entries.size(), [&](i64 i) {
+    is_suffix[i] = entries[i - 1].str.ends_with(entries[i].str);
+  });
+
+  // A string that is a suffix of the previous one is also a suffix of
+  // the first string of the run, so we merge it into that string as
+  // long as the tail is aligned properly.
+  std::vector<std::pair<i64, i64>> vec2;
+  i64 root = -1;
+
+  for (i64 i = 0; i < entries.size(); i++) {
+    if (is_suffix[i]) {
+      SectionFragment<E> &frag = map.values[entries[i].idx];
+      SectionFragment<E> &parent = map.values[entries[root].idx];
+      i64 delta = entries[root].str.size() - entries[i].str.size();
+
+      if (frag.p2align <= parent.p2align &&
+          delta % ((i64)1 << frag.p2align) == 0) {
+        vec2.push_back({entries[i].idx, entries[root].idx});
+        continue;
+      }
+    }
+    root = i;
+  }
+
+  static Counter counter("tail_merged_strings");
+  counter += vec2.size();
+  return vec2;
+}
+
 template <typename E>
 void MergedSection<E>::assign_offsets(Context<E> &ctx) {
   std::vector<i64> sizes(map.NUM_SHARDS);
@@ -1359,6 +1792,14 @@ void MergedSection<E>::assign_offsets(Context<E> &ctx) {
 
   i64 shard_size = map.nbuckets / map.NUM_SHARDS;
 
+  std::vector<std::pair<i64, i64>> tails;
+  if (ctx.arg.optimize >= 2 && !has_non_strings && map.nbuckets) {
+    tails = find_tail_merged_strings(ctx);
+    is_tail_merged.resize(map.nbuckets);
+    for (std::pair<i64, i64> &p : tails)
+      is_tail_merged[p.first] = true;
+  }
+
   tbb::parallel_for((i64)0, map.NUM_SHARDS, [&](i64 i) {
     struct KeyVal {
       std::string_view key;
@@ -1370,13 +1811,14 @@ void MergedSection<E>::assign_offsets(Context<E> &ctx) {
 
     for (i64 j = shard_size * i; j < shard_size * (i + 1); j++)
       if (SectionFragment<E> &frag = map.values[j]; frag.is_alive)
-        fragments.push_back({{map.keys[j], map.sizes[j]}, &frag});
+        if (is_tail_merged.empty() || !is_tail_merged[j])
+          fragments.push_back({{map.keys[j], map.sizes[j]}, &frag});
 
     // Sort fragments to make output deterministic.
     tbb::parallel_sort(fragments.begin(), fragments.end(),
                        [](const KeyVal &a, const KeyVal &b) {
-      if (a.val->alignment != b.val->alignment)
-        return a.val->alignment < b.val->alignment;
+      if (a.val->p2align != b.val->p2align)
+        return a.val->p2align < b.val->p2align;
       if (a.key.size() != b.key.size())
         return a.key.size() < b.key.size();
       return a.key < b.key;
@@ -1388,12 +1830,18 @@ void MergedSection<E>::assign_offsets(Context<E> &ctx) {
 
     for (KeyVal &kv : fragments) {
       SectionFragment<E> &frag = *kv.val;
-      offset = align_to(offset, frag.alignment);
+      i64 alignment = (i64)1 << frag.p2align;
+      offset = align_to(offset, alignment);
       frag.offset = offset;
+      frag.shard_idx = i;
       offset += kv.key.size();
-      max_alignment = std::max<i64>(max_alignment, frag.alignment);
+      max_alignment = std::max(max_alignment, alignment);
     }
 
+    // Fragment offsets are 32 bits, so each shard can be up to 4 GiB.
+    if (offset > UINT32_MAX)
+      Fatal(ctx) << this->name << ": merged section too large";
+
     sizes[i] = offset;
     max_alignments[i] = max_alignment;
 
@@ -1401,20 +1849,25 @@ void MergedSection<E>::assign_offsets(Context<E> &ctx) {
     merged_strings += fragments.size();
   });
 
+  // Make tail-merged strings point to the strings they are merged into.
+  tbb::parallel_for((i64)0, (i64)tails.size(), [&](i64 i) {
+    SectionFragment<E> &frag = map.values[tails[i].first];
+    SectionFragment<E> &parent = map.values[tails[i].second];
+    frag.shard_idx = parent.shard_idx;
+    frag.offset = parent.offset + map.sizes[tails[i].second] -
+                  map.sizes[tails[i].first];
+  });
+
   i64 alignment = 1;
   for (i64 x : max_alignments)
     alignment = std::max(alignment, x);
 
+  // Fragment offsets are relative to their shards, so we don't need
+  // to update fragments here.
   for (i64 i = 1; i < map.NUM_SHARDS + 1; i++)
     shard_offsets[i] =
       align_to(shard_offsets[i - 1] + sizes[i - 1], alignment);
 
-  tbb::parallel_for((i64)1, map.NUM_SHARDS, [&](i64 i) {
-    for (i64 j = shard_size * i; j < shard_size * (i + 1); j++)
-      if (SectionFragment<E> &frag = map.values[j]; frag.is_alive)
-        frag.offset += shard_offsets[i];
-  });
-
   this->shdr.sh_size = shard_offsets[map.NUM_SHARDS];
   this->shdr.sh_addralign = alignment;
 }
@@ -1433,7 +1886,9 @@ void MergedSection<E>::write_to(Context<E> &ctx, u8 *buf) {
 
     for (i64 j = shard_size * i; j < shard_size * (i + 1); j++)
       if (SectionFragment<E> &frag = map.values[j]; frag.is_alive)
-        memcpy(buf + frag.offset, map.keys[j], map.sizes[j]);
+        if (is_tail_merged.empty() || !is_tail_merged[j])
+          memcpy(buf + shard_offsets[i] + frag.offset, map.keys[j],
+                 map.sizes[j]);
   });
 }
 
@@ -1485,6 +1940,11 @@ void EhFrameSection<E>::construct(Context<E> &ctx) {
     offset += file->fde_size;
   }
 
+  // CIE pointers in FDEs are 32 bits, so .eh_frame cannot be larger
+  // than 4 GiB.
+  if (offset + 4 > UINT32_MAX)
+    Fatal(ctx) << ".eh_frame: section too large";
+
   // .eh_frame must end with a null word.
   this->shdr.sh_size = offset + 4;
 }
@@ -1507,7 +1967,7 @@ void EhFrameSection<E>::copy_buf(Context<E> &ctx) {
           continue;
         assert(rel.r_offset - cie.input_offset < contents.size());
         u64 loc = cie.output_offset + rel.r_offset - cie.input_offset;
-        u64 val = file->symbols[rel.r_sym]->get_addr(ctx);
+        u64 val = file->symbol_addrs[rel.r_sym];
         u64 addend = cie.input_section.get_addend(rel);
         apply_reloc(ctx, rel, loc, val + addend);
       }
@@ -1527,7 +1987,7 @@ void EhFrameSection<E>::copy_buf(Context<E> &ctx) {
           continue;
         assert(rel.r_offset - fde.input_offset < contents.size());
         u64 loc = offset + rel.r_offset - fde.input_offset;
-        u64 val = file->symbols[rel.r_sym]->get_addr(ctx);
+        u64 val = file->symbol_addrs[rel.r_sym];
         u64 addend = fde.cie->input_section.get_addend(rel);
         apply_reloc(ctx, rel, loc, val + addend);
       }
@@ -1573,7 +2033,7 @@ void EhFrameHdrSection<E>::copy_buf(Context<E> &ctx) {
       FdeRecord<E> &fde = file->fdes[i];
 
       ElfRel<E> &rel = fde.cie->rels[fde.rel_idx];
-      u64 val = file->symbols[rel.r_sym]->get_addr(ctx);
+      u64 val = file->symbol_addrs[rel.r_sym];
       u64 addend = fde.cie->input_section.get_addend(rel);
       i64 offset = file->fde_offset + fde.output_offset;
 
@@ -2004,6 +2464,7 @@ void ReproSection<E>::copy_buf(Context<E> &ctx) {
   template class RelPltSection<E>;                                      \
   template class RelDynSection<E>;                                      \
   template class RelrDynSection<E>;                                     \
+  template class AndroidRelDynSection<E>;                               \
   template class StrtabSection<E>;                                      \
   template class ShstrtabSection<E>;                                    \
   template class DynstrSection<E>;                                      \
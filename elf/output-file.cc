@@ -4,6 +4,8 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <tbb/parallel_for.h>
 
 namespace mold::elf {
 
@@ -71,37 +73,191 @@ public:
   }
 };
 
+// MemoryMappedOutputFile rewrites every byte of an output file even if
+// we are overwriting an existing file with mostly the same contents.
+// That dirties all pages, and the kernel has to write them all back to
+// disk. It also invalidates page caches of processes using the file.
+//
+// This class builds an output image in an anonymous buffer instead,
+// and on close, compares it with the existing file contents page by
+// page, copying only pages that differ. It is used if --reuse-output
+// is given and the output file already exists.
+template <typename E>
+class DiffingOutputFile : public OutputFile<E> {
+public:
+  DiffingOutputFile(Context<E> &ctx, std::string path, i64 filesize, i64 perm)
+    : OutputFile<E>(path, filesize, false) {
+    i64 fd;
+    std::tie(fd, output_tmpfile) = open_or_create_file(ctx, path, filesize, perm);
+
+    old_buf = (u8 *)mmap(nullptr, filesize, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    if (old_buf == MAP_FAILED)
+      Fatal(ctx) << path << ": mmap failed: " << errno_string();
+    ::close(fd);
+
+    this->buf = (u8 *)mmap(nullptr, filesize, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (this->buf == MAP_FAILED)
+      Fatal(ctx) << "mmap failed: " << errno_string();
+  }
+
+  void close(Context<E> &ctx) override {
+    Timer t(ctx, "close_file");
+
+    static Counter clean_pages("clean_pages");
+    static Counter dirty_pages("dirty_pages");
+
+    constexpr i64 page_size = 4096;
+    i64 num_pages = align_to(this->filesize, page_size) / page_size;
+
+    // memcmp is vectorized in libc, so this is usually much faster
+    // than writing back pages.
+    tbb::parallel_for((i64)0, num_pages, [&](i64 i) {
+      i64 offset = i * page_size;
+      i64 size = std::min<i64>(page_size, this->filesize - offset);
+
+      if (memcmp(old_buf + offset, this->buf + offset, size)) {
+        memcpy(old_buf + offset, this->buf + offset, size);
+        dirty_pages++;
+      } else {
+        clean_pages++;
+      }
+    });
+
+    munmap(old_buf, this->filesize);
+    munmap(this->buf, this->filesize);
+
+    if (rename(output_tmpfile, this->path.c_str()) == -1)
+      Fatal(ctx) << this->path << ": rename failed: " << errno_string();
+    output_tmpfile = nullptr;
+  }
+
+private:
+  u8 *old_buf = nullptr;
+};
+
+// MallocOutputFile is used if the output is not a regular file (e.g.
+// stdout or a named pipe). We cannot mmap such file, so we build an
+// output image in an anonymous buffer and write it out.
+//
+// If start_streaming() is called, we write out a prefix of the buffer
+// as soon as all chunks in the prefix are complete, so that a reader
+// on the other side of a pipe can start processing the output before
+// the linker finishes. If the output is a pipe, we use vmsplice(2) to
+// avoid copying the buffer contents to the kernel.
 template <typename E>
 class MallocOutputFile : public OutputFile<E> {
 public:
   MallocOutputFile(Context<E> &ctx, std::string path, i64 filesize, i64 perm)
-    : OutputFile<E>(path, filesize, false), perm(perm) {
+    : OutputFile<E>(path, filesize, false) {
     this->buf = (u8 *)mmap(NULL, filesize, PROT_READ | PROT_WRITE,
                            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
     if (this->buf == MAP_FAILED)
       Fatal(ctx) << "mmap failed: " << errno_string();
+
+    if (path == "-") {
+      fflush(stdout);
+      fd = STDOUT_FILENO;
+    } else {
+      fd = ::open(path.c_str(), O_WRONLY | O_CREAT, perm);
+      if (fd == -1)
+        Fatal(ctx) << "cannot open " << path << ": " << errno_string();
+    }
+
+    struct stat st;
+    is_pipe = (fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode));
   }
 
-  void close(Context<E> &ctx) override {
-    Timer t(ctx, "close_file");
+  void start_streaming(Context<E> &ctx) override {
+    for (Chunk<E> *chunk : ctx.chunks)
+      if (chunk->shdr.sh_type != SHT_NOBITS)
+        chunks.push_back(chunk);
 
-    if (this->path == "-") {
-      fwrite(this->buf, this->filesize, 1, stdout);
-      fclose(stdout);
+    sort(chunks, [](Chunk<E> *a, Chunk<E> *b) {
+      return a->shdr.sh_offset < b->shdr.sh_offset;
+    });
+
+    done.reset(new std::atomic_bool[chunks.size()]);
+    for (i64 i = 0; i < chunks.size(); i++) {
+      done[i] = false;
+      chunk_idx[chunks[i]] = i;
+    }
+  }
+
+  void notify_chunk_done(Context<E> &ctx, Chunk<E> *chunk) override {
+    auto it = chunk_idx.find(chunk);
+    if (it == chunk_idx.end())
       return;
+
+    done[it->second] = true;
+
+    // Only one thread writes to the output at a time. If we fail to get
+    // the lock, the thread that holds it will pick up our chunk.
+    while (mu.try_lock()) {
+      i64 end = num_done;
+      while (end < chunks.size() && done[end])
+        end++;
+
+      if (end != num_done) {
+        i64 offset = (end == chunks.size())
+          ? this->filesize : (i64)chunks[end]->shdr.sh_offset;
+        write_to(ctx, offset);
+        num_done = end;
+      }
+      mu.unlock();
+
+      if (num_done == chunks.size() || !done[num_done])
+        return;
     }
+  }
 
-    i64 fd = ::open(this->path.c_str(), O_RDWR | O_CREAT, perm);
-    if (fd == -1)
-      Fatal(ctx) << "cannot open " << this->path << ": " << errno_string();
+  void close(Context<E> &ctx) override {
+    Timer t(ctx, "close_file");
 
-    FILE *fp = fdopen(fd, "w");
-    fwrite(this->buf, this->filesize, 1, fp);
-    fclose(fp);
+    std::scoped_lock lock(mu);
+    write_to(ctx, this->filesize);
+
+    if (this->path == "-")
+      fclose(stdout);
+    else
+      ::close(fd);
   }
 
 private:
-  i64 perm;
+  // Writes buf[written, end) to the output.
+  void write_to(Context<E> &ctx, i64 end) {
+    while (written < end) {
+      i64 n;
+      if (is_pipe) {
+        iovec iov = {this->buf + written, (size_t)(end - written)};
+        n = vmsplice(fd, &iov, 1, 0);
+        if (n == -1 && errno == EINVAL) {
+          is_pipe = false;
+          continue;
+        }
+      } else {
+        n = ::write(fd, this->buf + written, end - written);
+      }
+
+      if (n == -1) {
+        if (errno == EINTR)
+          continue;
+        Fatal(ctx) << this->path << ": write failed: " << errno_string();
+      }
+      written += n;
+    }
+  }
+
+  i64 fd = -1;
+  bool is_pipe = false;
+  i64 written = 0;
+
+  std::vector<Chunk<E> *> chunks;
+  std::unordered_map<Chunk<E> *, i64> chunk_idx;
+  std::unique_ptr<std::atomic_bool[]> done;
+  std::atomic<i64> num_done = 0;
+  std::mutex mu;
 };
 
 template <typename E>
@@ -113,20 +269,32 @@ OutputFile<E>::open(Context<E> &ctx, std::string path, i64 filesize, i64 perm) {
     path = ctx.arg.chroot + "/" + path_clean(path);
 
   bool is_special = false;
+  bool exists = false;
+
   if (path == "-") {
     is_special = true;
   } else {
     struct stat st;
-    if (stat(path.c_str(), &st) == 0 && (st.st_mode & S_IFMT) != S_IFREG)
-      is_special = true;
+    if (stat(path.c_str(), &st) == 0) {
+      exists = true;
+      if ((st.st_mode & S_IFMT) != S_IFREG)
+        is_special = true;
+    }
   }
 
   std::unique_ptr<OutputFile<E>> file;
   if (is_special)
     file = std::make_unique<MallocOutputFile<E>>(ctx, path, filesize, perm);
+  else if (ctx.arg.reuse_output && exists)
+    file = std::make_unique<DiffingOutputFile<E>>(ctx, path, filesize, perm);
   else
     file = std::make_unique<MemoryMappedOutputFile<E>>(ctx, path, filesize, perm);
 
+  // Do this before we touch the buffer for the first time, so that
+  // page faults allocate huge pages from the beginning.
+  if (ctx.arg.huge_pages)
+    madvise_huge_pages(file->buf, filesize);
+
   if (ctx.arg.filler != -1)
     memset(file->buf, ctx.arg.filler, filesize);
   return file;
@@ -44,6 +44,8 @@ void create_synthetic_sections(Context<E> &ctx) {
 
   if (ctx.arg.pack_dyn_relocs_relr)
     add(ctx.relrdyn = std::make_unique<RelrDynSection<E>>());
+  if (ctx.arg.pack_dyn_relocs_android)
+    add(ctx.android_reldyn = std::make_unique<AndroidRelDynSection<E>>());
 
   add(ctx.strtab = std::make_unique<StrtabSection<E>>());
   add(ctx.shstrtab = std::make_unique<ShstrtabSection<E>>());
@@ -79,9 +81,7 @@ void create_synthetic_sections(Context<E> &ctx) {
 }
 
 template <typename E>
-void resolve_symbols(Context<E> &ctx) {
-  Timer t(ctx, "resolve_symbols");
-
+static void do_resolve_symbols(Context<E> &ctx) {
   std::vector<InputFile<E> *> files;
   append(files, ctx.objs);
   append(files, ctx.dsos);
@@ -131,6 +131,46 @@ void resolve_symbols(Context<E> &ctx) {
   std::erase_if(ctx.dsos, [](InputFile<E> *file) { return !file->is_alive; });
 }
 
+template <typename E>
+void resolve_symbols(Context<E> &ctx) {
+  Timer t(ctx, "resolve_symbols");
+
+  std::vector<ObjectFile<E> *> objs = ctx.objs;
+  std::vector<SharedFile<E> *> dsos = ctx.dsos;
+
+  do_resolve_symbols(ctx);
+
+  if (ctx.has_lto_object) {
+    // Let the LTO plugin compile IR object files into native object
+    // files. It appends the new files to ctx.objs.
+    i64 num_objs = ctx.objs.size();
+    i64 num_dsos = ctx.dsos.size();
+    do_lto(ctx);
+
+    // The new files may refer to archive members that we have removed
+    // above, so restore the original file lists.
+    objs.insert(objs.end(), ctx.objs.begin() + num_objs, ctx.objs.end());
+    dsos.insert(dsos.end(), ctx.dsos.begin() + num_dsos, ctx.dsos.end());
+    ctx.objs = objs;
+    ctx.dsos = dsos;
+
+    // Replace IR object files with the native ones and redo symbol
+    // resolution.
+    for (ObjectFile<E> *file : ctx.objs) {
+      if (file->is_lto_obj) {
+        file->is_alive = false;
+        file->clear_symbols(ctx);
+      }
+    }
+
+    std::erase_if(ctx.objs, [](ObjectFile<E> *file) {
+      return file->is_lto_obj;
+    });
+
+    do_resolve_symbols(ctx);
+  }
+}
+
 template <typename E>
 void eliminate_comdats(Context<E> &ctx) {
   Timer t(ctx, "eliminate_comdats");
@@ -179,7 +219,7 @@ void compute_merged_section_sizes(Context<E> &ctx) {
   // Mark section fragments referenced by live objects.
   if (!ctx.arg.gc_sections) {
     tbb::parallel_for_each(ctx.objs, [](ObjectFile<E> *file) {
-      for (std::unique_ptr<MergeableSection<E>> &m : file->mergeable_sections)
+      for (MergeableSection<E> *m : file->mergeable_sections)
         if (m)
           for (SectionFragment<E> *frag : m->fragments)
             frag->is_alive.store(true, std::memory_order_relaxed);
@@ -233,27 +273,49 @@ void bin_sections(Context<E> &ctx) {
 
   i64 num_osec = ctx.output_sections.size();
 
-  std::vector<std::vector<std::vector<InputSection<E> *>>> groups(slices.size());
+  // We read section sizes and alignments here, while input sections
+  // are in cache anyway, so that compute_section_sizes() doesn't have
+  // to touch them again.
+  struct Group {
+    std::vector<InputSection<E> *> members;
+    std::vector<u64> sizes;
+    std::vector<u8> p2aligns;
+  };
+
+  std::vector<std::vector<Group>> groups(slices.size());
   for (i64 i = 0; i < groups.size(); i++)
     groups[i].resize(num_osec);
 
   tbb::parallel_for((i64)0, (i64)slices.size(), [&](i64 i) {
-    for (ObjectFile<E> *file : slices[i])
-      for (std::unique_ptr<InputSection<E>> &isec : file->sections)
-        if (isec && isec->is_alive)
-          groups[i][isec->output_section->idx].push_back(isec.get());
+    for (ObjectFile<E> *file : slices[i]) {
+      for (InputSection<E> *isec : file->sections) {
+        if (isec && isec->is_alive) {
+          Group &group = groups[i][isec->output_section->idx];
+          group.members.push_back(isec);
+          group.sizes.push_back(isec->shdr.sh_size);
+          group.p2aligns.push_back(to_p2align(isec->shdr.sh_addralign));
+        }
+      }
+    }
   });
 
   std::vector<i64> sizes(num_osec);
 
-  for (std::span<std::vector<InputSection<E> *>> group : groups)
+  for (std::span<Group> group : groups)
     for (i64 i = 0; i < group.size(); i++)
-      sizes[i] += group[i].size();
+      sizes[i] += group[i].members.size();
 
   tbb::parallel_for((i64)0, num_osec, [&](i64 j) {
-    ctx.output_sections[j]->members.reserve(sizes[j]);
-    for (i64 i = 0; i < groups.size(); i++)
-      append(ctx.output_sections[j]->members, groups[i][j]);
+    OutputSection<E> &osec = *ctx.output_sections[j];
+    osec.members.reserve(sizes[j]);
+    osec.member_sizes.reserve(sizes[j]);
+    osec.member_p2aligns.reserve(sizes[j]);
+
+    for (i64 i = 0; i < groups.size(); i++) {
+      append(osec.members, groups[i][j].members);
+      append(osec.member_sizes, groups[i][j].sizes);
+      append(osec.member_p2aligns, groups[i][j].p2aligns);
+    }
   });
 }
 
@@ -438,8 +500,130 @@ void sort_init_fini(Context<E> &ctx) {
       sort(osec->members, [&](InputSection<E> *a, InputSection<E> *b) {
         return get_priority(a) < get_priority(b);
       });
+      osec->update_member_attrs();
+    }
+  }
+}
+
+// Move input sections in `order` to the beginning of their output
+// sections in ascending order of their values. The other sections keep
+// their relative order.
+template <typename E>
+void sort_output_section_members(
+    Context<E> &ctx, std::unordered_map<InputSection<E> *, i64> &order) {
+  if (order.empty())
+    return;
+
+  tbb::parallel_for_each(ctx.output_sections,
+                         [&](std::unique_ptr<OutputSection<E>> &osec) {
+    // .init_array and .fini_array have already been sorted by
+    // sort_init_fini().
+    u32 type = osec->shdr.sh_type;
+    if (type == SHT_INIT_ARRAY || type == SHT_FINI_ARRAY ||
+        type == SHT_PREINIT_ARRAY)
+      return;
+
+    std::vector<std::pair<i64, InputSection<E> *>> ordered;
+    std::vector<InputSection<E> *> rest;
+
+    for (InputSection<E> *isec : osec->members) {
+      if (auto it = order.find(isec); it != order.end())
+        ordered.push_back({it->second, isec});
+      else
+        rest.push_back(isec);
+    }
+
+    if (ordered.empty())
+      return;
+
+    sort(ordered, [](auto &a, auto &b) { return a.first < b.first; });
+
+    osec->members.clear();
+    for (auto [rank, isec] : ordered)
+      osec->members.push_back(isec);
+    append(osec->members, rest);
+    osec->update_member_attrs();
+  });
+}
+
+// Move input sections containing symbols listed in
+// --symbol-ordering-file to the beginning of their output sections in
+// the order of the symbols in the file. The other sections are left in
+// the order bin_sections() created.
+template <typename E>
+void sort_by_symbol_ordering_file(Context<E> &ctx) {
+  Timer t(ctx, "sort_by_symbol_ordering_file");
+
+  std::span<std::string_view> names = ctx.arg.symbol_ordering_file;
+  std::unordered_map<std::string_view, i64> order;
+  for (i64 i = 0; i < names.size(); i++)
+    order.insert({names[i], i});
+
+  // Find sections defining listed symbols. Local symbols can be
+  // ordered too.
+  std::vector<std::vector<std::pair<InputSection<E> *, i64>>>
+    matches(ctx.objs.size());
+  // For each listed symbol, remember how far we got in finding it so
+  // that we can report a meaningful warning for unmatched ones.
+  enum : u8 { NOT_FOUND, NO_SECTION, DISCARDED, MATCHED };
+  std::vector<std::atomic_uint8_t> status(names.size());
+
+  tbb::parallel_for((i64)0, (i64)ctx.objs.size(), [&](i64 i) {
+    ObjectFile<E> *file = ctx.objs[i];
+
+    for (Symbol<E> *sym : file->symbols) {
+      if (sym->file != file)
+        continue;
+
+      auto it = order.find(sym->name());
+      if (it == order.end())
+        continue;
+
+      if (InputSection<E> *isec = sym->input_section) {
+        if (isec->is_alive) {
+          matches[i].push_back({isec, it->second});
+          update_maximum(status[it->second], MATCHED);
+        } else {
+          update_maximum(status[it->second], DISCARDED);
+        }
+      } else {
+        update_maximum(status[it->second], NO_SECTION);
+      }
+    }
+  });
+
+  if (ctx.arg.warn_symbol_ordering) {
+    for (i64 i = 0; i < names.size(); i++) {
+      if (order[names[i]] != i)
+        continue;
+
+      switch (status[i]) {
+      case NOT_FOUND:
+        Warn(ctx) << "--symbol-ordering-file: no such symbol: " << names[i];
+        break;
+      case NO_SECTION:
+        Warn(ctx) << "--symbol-ordering-file: unable to order absolute symbol: "
+                  << names[i];
+        break;
+      case DISCARDED:
+        Warn(ctx) << "--symbol-ordering-file: unable to order discarded symbol: "
+                  << names[i];
+        break;
+      }
     }
   }
+
+  // A section gets the smallest rank of the symbols it defines.
+  std::unordered_map<InputSection<E> *, i64> ranks;
+  for (std::span<std::pair<InputSection<E> *, i64>> vec : matches) {
+    for (auto [isec, rank] : vec) {
+      auto [it, inserted] = ranks.insert({isec, rank});
+      if (!inserted)
+        it->second = std::min(it->second, rank);
+    }
+  }
+
+  sort_output_section_members(ctx, ranks);
 }
 
 template <typename E>
@@ -471,7 +655,8 @@ void compute_section_sizes(Context<E> &ctx) {
     i64 size = 0;
     i64 alignment = 1;
     i64 offset = 0;
-    std::span<InputSection<E> *> members;
+    i64 begin = 0;
+    i64 end = 0;
   };
 
   tbb::parallel_for_each(ctx.output_sections,
@@ -482,14 +667,22 @@ void compute_section_sizes(Context<E> &ctx) {
     std::vector<Group> groups;
     constexpr i64 group_size = 10000;
 
-    for (std::span<InputSection<E> *> span : split(osec->members, group_size))
-      groups.push_back(Group{.members = span});
+    for (i64 i = 0; i < osec->members.size(); i += group_size)
+      groups.push_back(Group{
+        .begin = i,
+        .end = std::min<i64>(i + group_size, osec->members.size()),
+      });
+
+    // Sizes and alignments are read from contiguous arrays rather
+    // than from input sections themselves.
+    std::span<u64> sizes = osec->member_sizes;
+    std::span<u8> p2aligns = osec->member_p2aligns;
 
-    tbb::parallel_for_each(groups, [](Group &group) {
-      for (InputSection<E> *isec : group.members) {
-        group.size = align_to(group.size, isec->shdr.sh_addralign) +
-                     isec->shdr.sh_size;
-        group.alignment = std::max<i64>(group.alignment, isec->shdr.sh_addralign);
+    tbb::parallel_for_each(groups, [&](Group &group) {
+      for (i64 i = group.begin; i < group.end; i++) {
+        i64 align = (i64)1 << p2aligns[i];
+        group.size = align_to(group.size, align) + sizes[i];
+        group.alignment = std::max(group.alignment, align);
       }
     });
 
@@ -503,16 +696,19 @@ void compute_section_sizes(Context<E> &ctx) {
       align = std::max(align, groups[i].alignment);
     }
 
+    if (offset >= ((i64)1 << 48))
+      Fatal(ctx) << osec->name << ": output section too large";
+
     osec->shdr.sh_size = offset;
     osec->shdr.sh_addralign = align;
 
     // Assign offsets to input sections.
-    tbb::parallel_for_each(groups, [](Group &group) {
+    tbb::parallel_for_each(groups, [&](Group &group) {
       i64 offset = group.offset;
-      for (InputSection<E> *isec : group.members) {
-        offset = align_to(offset, isec->shdr.sh_addralign);
-        isec->offset = offset;
-        offset += isec->shdr.sh_size;
+      for (i64 i = group.begin; i < group.end; i++) {
+        offset = align_to(offset, (i64)1 << p2aligns[i]);
+        osec->members[i]->set_offset(offset);
+        offset += sizes[i];
       }
     });
   });
@@ -538,7 +734,7 @@ void scan_rels(Context<E> &ctx) {
   // Exit if there was a relocation that refers an undefined symbol.
   ctx.checkpoint();
 
-  // Aggregate dynamic symbols to a single vector.
+  // Aggregate dynamic symbols.
   std::vector<InputFile<E> *> files;
   append(files, ctx.objs);
   append(files, ctx.dsos);
@@ -546,93 +742,265 @@ void scan_rels(Context<E> &ctx) {
   std::vector<std::vector<Symbol<E> *>> vec(files.size());
 
   tbb::parallel_for((i64)0, (i64)files.size(), [&](i64 i) {
-    for (Symbol<E> *sym : files[i]->symbols)
-      if (sym->file == files[i])
-        if (sym->flags || sym->is_imported || sym->is_exported)
-          vec[i].push_back(sym);
+    for (Symbol<E> *sym : files[i]->symbols) {
+      if (sym->file == files[i] && sym->aux_idx == -1 &&
+          (sym->flags || sym->is_imported || sym->is_exported)) {
+        // A file may refer to the same symbol more than once.
+        // Mark it so that we visit each symbol only once.
+        sym->aux_idx = -2;
+        vec[i].push_back(sym);
+      }
+    }
   });
 
-  std::vector<Symbol<E> *> syms = flatten(vec);
-  ctx.symbol_aux.reserve(syms.size());
+  // If we need to create a canonical PLT, we can't use .plt.got
+  // because otherwise .plt.got and .got would refer each other,
+  // resulting in an infinite loop at runtime.
+  auto is_canonical = [&](Symbol<E> *sym) {
+    return !ctx.arg.pic && sym->is_imported;
+  };
 
-  auto add_aux = [&](Symbol<E> *sym) {
-    if (sym->aux_idx == -1) {
-      i64 sz = ctx.symbol_aux.size();
-      sym->aux_idx = sz;
-      ctx.symbol_aux.resize(sz + 1);
-    }
+  auto needs_pltgot = [&](Symbol<E> *sym) {
+    return (sym->flags & NEEDS_PLT) && (sym->flags & NEEDS_GOT) &&
+           !is_canonical(sym);
+  };
+
+  auto needs_plt = [&](Symbol<E> *sym) {
+    return (sym->flags & NEEDS_PLT) && !needs_pltgot(sym);
+  };
+
+  auto needs_dynsym = [&](Symbol<E> *sym) {
+    return sym->is_imported || sym->is_exported || needs_plt(sym) ||
+           (sym->flags & (NEEDS_TLSGD | NEEDS_TLSDESC));
   };
 
   // Assign offsets in additional tables for each dynamic symbol.
-  for (Symbol<E> *sym : syms) {
-    add_aux(sym);
+  // We do this in two passes so that we can do it in parallel. We
+  // first count the number of table entries each file needs, compute
+  // their prefix sums, and then let each file fill its own slots.
+  // The result is the same as if we visited all symbols one by one.
+  struct Slots {
+    i64 aux = 0;
+    i64 got = 0;
+    i64 gottp = 0;
+    i64 tlsgd = 0;
+    i64 tlsdesc = 0;
+    i64 got_words = 0;
+    i64 plt = 0;
+    i64 pltgot = 0;
+    i64 dynsym = 0;
+    bool tlsld = false;
+    bool copyrel = false;
+  };
+
+  std::vector<Slots> counts(files.size());
+
+  tbb::parallel_for((i64)0, (i64)files.size(), [&](i64 i) {
+    Slots &c = counts[i];
+
+    for (Symbol<E> *sym : vec[i]) {
+      c.aux++;
+
+      if (needs_dynsym(sym))
+        c.dynsym++;
+
+      if (sym->flags & NEEDS_GOT) {
+        c.got++;
+        c.got_words++;
+      }
+
+      if (needs_pltgot(sym))
+        c.pltgot++;
+      else if (needs_plt(sym))
+        c.plt++;
+
+      if (sym->flags & NEEDS_GOTTP) {
+        c.gottp++;
+        c.got_words++;
+      }
+
+      if (sym->flags & NEEDS_TLSGD) {
+        c.tlsgd++;
+        c.got_words += 2;
+      }
+
+      if (sym->flags & NEEDS_TLSDESC) {
+        c.tlsdesc++;
+        c.got_words += 2;
+      }
+
+      if (sym->flags & NEEDS_TLSLD)
+        c.tlsld = true;
 
-    if (sym->is_imported || sym->is_exported)
-      ctx.dynsym->add_symbol(ctx, sym);
+      if (sym->flags & NEEDS_COPYREL)
+        c.copyrel = true;
+    }
+  });
+
+  // Compute prefix sums. A TLSLD entry is shared by all symbols, so
+  // it's allocated only by the first file that needs it.
+  std::vector<Slots> offsets(files.size());
+  Slots total;
+  total.got_words = ctx.got->shdr.sh_size / E::word_size;
+  total.dynsym = ctx.dynsym->symbols.size();
+
+  i64 tlsld_file = -1;
+  if (ctx.got->tlsld_idx == -1) {
+    for (i64 i = 0; i < files.size(); i++) {
+      if (counts[i].tlsld) {
+        counts[i].got_words += 2;
+        tlsld_file = i;
+        break;
+      }
+    }
+  }
+
+  for (i64 i = 0; i < files.size(); i++) {
+    offsets[i] = total;
+    total.aux += counts[i].aux;
+    total.got += counts[i].got;
+    total.gottp += counts[i].gottp;
+    total.tlsgd += counts[i].tlsgd;
+    total.tlsdesc += counts[i].tlsdesc;
+    total.got_words += counts[i].got_words;
+    total.plt += counts[i].plt;
+    total.pltgot += counts[i].pltgot;
+    total.dynsym += counts[i].dynsym;
+    total.copyrel |= counts[i].copyrel;
+  }
+
+  // Copy relocations are rare, but they may add aliases of a symbol
+  // in any order to .dynsym. We fall back to the serial loop below
+  // to assign .dynsym slots if we have any copy relocation.
+  bool parallel_dynsym = !total.copyrel;
+
+  assert(ctx.symbol_aux.empty());
+  assert(ctx.plt->symbols.empty());
+  assert(ctx.pltgot->symbols.empty());
+
+  ctx.symbol_aux.resize(total.aux);
+  ctx.got->got_syms.resize(total.got);
+  ctx.got->gottp_syms.resize(total.gottp);
+  ctx.got->tlsgd_syms.resize(total.tlsgd);
+  ctx.got->tlsdesc_syms.resize(total.tlsdesc);
+  ctx.plt->symbols.resize(total.plt);
+  ctx.pltgot->symbols.resize(total.pltgot);
+  if (parallel_dynsym)
+    ctx.dynsym->symbols.resize(total.dynsym);
 
-    if (sym->flags & NEEDS_GOT)
-      ctx.got->add_got_symbol(ctx, sym);
+  tbb::parallel_for((i64)0, (i64)files.size(), [&](i64 i) {
+    Slots off = offsets[i];
+
+    for (Symbol<E> *sym : vec[i]) {
+      sym->aux_idx = off.aux++;
 
-    if (sym->flags & NEEDS_PLT) {
-      bool is_canonical = (!ctx.arg.pic && sym->is_imported);
+      if (parallel_dynsym && needs_dynsym(sym)) {
+        sym->set_dynsym_idx(ctx, -2);
+        ctx.dynsym->symbols[off.dynsym++] = sym;
+      }
+
+      if (sym->flags & NEEDS_GOT) {
+        sym->set_got_idx(ctx, off.got_words++);
+        ctx.got->got_syms[off.got++] = sym;
+      }
 
       // If a symbol needs a canonical PLT, it is considered both
       // imported and exported.
-      if (is_canonical)
+      if ((sym->flags & NEEDS_PLT) && is_canonical(sym))
         sym->is_exported = true;
 
-      if ((sym->flags & NEEDS_GOT) && !is_canonical) {
-        ctx.pltgot->add_symbol(ctx, sym);
-      } else{
-        // If we need to create a canonical PLT, we can't use .plt.got
-        // because otherwise .plt.got and .got would refer each other,
-        // resulting in an infinite loop at runtime.
-        ctx.plt->add_symbol(ctx, sym);
+      if (needs_pltgot(sym)) {
+        sym->set_pltgot_idx(ctx, off.pltgot);
+        ctx.pltgot->symbols[off.pltgot++] = sym;
+      } else if (needs_plt(sym)) {
+        // The first three .got.plt entries are reserved.
+        sym->set_plt_idx(ctx, off.plt);
+        sym->set_gotplt_idx(ctx, off.plt + 3);
+        ctx.plt->symbols[off.plt++] = sym;
+      }
+
+      if (sym->flags & NEEDS_GOTTP) {
+        sym->set_gottp_idx(ctx, off.got_words++);
+        ctx.got->gottp_syms[off.gottp++] = sym;
+      }
+
+      if (sym->flags & NEEDS_TLSGD) {
+        sym->set_tlsgd_idx(ctx, off.got_words);
+        off.got_words += 2;
+        ctx.got->tlsgd_syms[off.tlsgd++] = sym;
+      }
+
+      if (sym->flags & NEEDS_TLSDESC) {
+        sym->set_tlsdesc_idx(ctx, off.got_words);
+        off.got_words += 2;
+        ctx.got->tlsdesc_syms[off.tlsdesc++] = sym;
+      }
+
+      if ((sym->flags & NEEDS_TLSLD) && i == tlsld_file &&
+          ctx.got->tlsld_idx == -1) {
+        ctx.got->tlsld_idx = off.got_words;
+        off.got_words += 2;
       }
     }
+  });
 
-    if (sym->flags & NEEDS_GOTTP)
-      ctx.got->add_gottp_symbol(ctx, sym);
+  // Now that we know the number of entries, we can compute sizes.
+  ctx.got->shdr.sh_size = total.got_words * E::word_size;
 
-    if (sym->flags & NEEDS_TLSGD)
-      ctx.got->add_tlsgd_symbol(ctx, sym);
+  if (total.plt) {
+    ctx.plt->shdr.sh_size = ctx.plt_hdr_size + total.plt * ctx.plt_size;
+    ctx.gotplt->shdr.sh_size = E::word_size * (total.plt + 3);
+    ctx.relplt->shdr.sh_size = sizeof(ElfRel<E>) * total.plt;
+  }
+
+  ctx.pltgot->shdr.sh_size = E::pltgot_size * total.pltgot;
 
-    if (sym->flags & NEEDS_TLSDESC)
-      ctx.got->add_tlsdesc_symbol(ctx, sym);
+  if (!parallel_dynsym) {
+    for (std::vector<Symbol<E> *> &syms : vec) {
+      for (Symbol<E> *sym : syms) {
+        if (needs_dynsym(sym))
+          ctx.dynsym->add_symbol(ctx, sym);
 
-    if (sym->flags & NEEDS_TLSLD)
-      ctx.got->add_tlsld(ctx);
+        if (!(sym->flags & NEEDS_COPYREL))
+          continue;
 
-    if (sym->flags & NEEDS_COPYREL) {
-      assert(sym->file->is_dso);
-      SharedFile<E> *file = (SharedFile<E> *)sym->file;
-      sym->copyrel_readonly = file->is_readonly(ctx, sym);
+        assert(sym->file->is_dso);
+        SharedFile<E> *file = (SharedFile<E> *)sym->file;
+        sym->copyrel_readonly = file->is_readonly(ctx, sym);
 
-      if (sym->copyrel_readonly)
-        ctx.dynbss_relro->add_symbol(ctx, sym);
-      else
-        ctx.dynbss->add_symbol(ctx, sym);
-
-      // If a symbol needs copyrel, it is considered both imported
-      // and exported.
-      assert(sym->is_imported);
-      sym->is_exported = true;
-
-      // Aliases of this symbol are also copied so that they will be
-      // resolved to the same address at runtime.
-      for (Symbol<E> *alias : file->find_aliases(sym)) {
-        add_aux(alias);
-        alias->is_imported = true;
-        alias->is_exported = true;
-        alias->has_copyrel = true;
-        alias->value = sym->value;
-        alias->copyrel_readonly = sym->copyrel_readonly;
-        ctx.dynsym->add_symbol(ctx, alias);
+        if (sym->copyrel_readonly)
+          ctx.dynbss_relro->add_symbol(ctx, sym);
+        else
+          ctx.dynbss->add_symbol(ctx, sym);
+
+        // If a symbol needs copyrel, it is considered both imported
+        // and exported.
+        assert(sym->is_imported);
+        sym->is_exported = true;
+
+        // Aliases of this symbol are also copied so that they will be
+        // resolved to the same address at runtime.
+        for (Symbol<E> *alias : file->find_aliases(sym)) {
+          if (alias->aux_idx == -1) {
+            alias->aux_idx = ctx.symbol_aux.size();
+            ctx.symbol_aux.resize(ctx.symbol_aux.size() + 1);
+          }
+
+          alias->is_imported = true;
+          alias->is_exported = true;
+          alias->has_copyrel = true;
+          alias->value = sym->value;
+          alias->copyrel_readonly = sym->copyrel_readonly;
+          ctx.dynsym->add_symbol(ctx, alias);
+        }
       }
     }
-
-    sym->flags = 0;
   }
+
+  tbb::parallel_for_each(vec, [](std::vector<Symbol<E> *> &syms) {
+    for (Symbol<E> *sym : syms)
+      sym->flags = 0;
+  });
 }
 
 template <typename E>
@@ -647,6 +1015,18 @@ void construct_relr(Context<E> &ctx) {
   ctx.got->construct_relr(ctx);
 }
 
+template <typename E>
+void construct_android_relocs(Context<E> &ctx) {
+  Timer t(ctx, "construct_android_relocs");
+
+  tbb::parallel_for_each(ctx.output_sections,
+                         [&](std::unique_ptr<OutputSection<E>> &osec) {
+    osec->construct_android_relocs(ctx);
+  });
+
+  ctx.got->construct_android_relocs(ctx);
+}
+
 template <typename E>
 void apply_version_script(Context<E> &ctx) {
   Timer t(ctx, "apply_version_script");
@@ -1087,6 +1467,35 @@ void compress_debug_sections(Context<E> &ctx) {
   ctx.shdr->update_shdr(ctx);
 }
 
+// Symbol::get_addr() needs to take many conditions into account, and
+// it's called for each relocation, which can easily be billions for
+// a large program with debug info. Since symbol addresses don't change
+// once the layout is fixed, we compute them only once here.
+template <typename E>
+void compute_symbol_addrs(Context<E> &ctx) {
+  Timer t(ctx, "compute_symbol_addrs");
+
+  tbb::parallel_for_each(ctx.objs, [&](ObjectFile<E> *file) {
+    file->symbol_addrs.resize(file->symbols.size());
+    tbb::parallel_for((i64)0, (i64)file->symbols.size(), [&](i64 i) {
+      file->symbol_addrs[i] = file->symbols[i]->get_addr(ctx);
+    });
+
+    file->slow_reloc_syms.resize(file->symbols.size());
+
+    for (i64 i = 0; i < file->symbols.size(); i++) {
+      if (!file->symbols[i]->file) {
+        file->slow_reloc_syms[i] = true;
+      } else if (i < file->first_global) {
+        const ElfSym<E> &esym = file->elf_syms[i];
+        if (esym.st_type == STT_SECTION &&
+            file->mergeable_sections[file->get_shndx(esym)])
+          file->slow_reloc_syms[i] = true;
+      }
+    }
+  });
+}
+
 #define INSTANTIATE(E)                                                  \
   template void apply_exclude_libs(Context<E> &);                       \
   template void create_synthetic_sections(Context<E> &);                \
@@ -1099,11 +1508,15 @@ void compress_debug_sections(Context<E> &ctx) {
   template void check_cet_errors(Context<E> &);                         \
   template void check_duplicate_symbols(Context<E> &);                  \
   template void sort_init_fini(Context<E> &);                           \
+  template void sort_by_symbol_ordering_file(Context<E> &);             \
+  template void sort_output_section_members(                            \
+    Context<E> &, std::unordered_map<InputSection<E> *, i64> &);        \
   template std::vector<Chunk<E> *> collect_output_sections(Context<E> &); \
   template void compute_section_sizes(Context<E> &);                    \
   template void claim_unresolved_symbols(Context<E> &);                 \
   template void scan_rels(Context<E> &);                                \
   template void construct_relr(Context<E> &);                           \
+  template void construct_android_relocs(Context<E> &);                 \
   template void apply_version_script(Context<E> &);                     \
   template void parse_symbol_version(Context<E> &);                     \
   template void compute_import_export(Context<E> &);                    \
@@ -1111,7 +1524,8 @@ void compress_debug_sections(Context<E> &ctx) {
   template i64 get_section_rank(Context<E> &, Chunk<E> *);              \
   template i64 set_osec_offsets(Context<E> &);                          \
   template void fix_synthetic_symbols(Context<E> &);                    \
-  template void compress_debug_sections(Context<E> &);
+  template void compress_debug_sections(Context<E> &);                  \
+  template void compute_symbol_addrs(Context<E> &);
 
 INSTANTIATE(X86_64);
 INSTANTIATE(I386);
@@ -9,9 +9,13 @@
 // independent feature from others. That's why this file share only a
 // small amount of code with other files.
 //
-// Since the -r option is a minor feature, we don't aim for speed in
-// this file. This is a "better than nothing" implementation of the -r
-// option.
+// That said, we still use the same parallel techniques as the regular
+// code path does. Input files are parsed in parallel, archive members
+// are pulled in by a parallel graph traversal, COMDAT groups are
+// deduplicated using `ctx.comdat_groups`, and the symbol table is built
+// by each file independently once we compute per-file offsets with
+// prefix sums. Each chunk is then written directly to the mmap'ed
+// output file in parallel.
 //
 // Here is the strategy as to how to combine multiple object files
 // into one:
@@ -29,8 +33,9 @@
 #include "mold.h"
 #include "../archive-file.h"
 
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_for_each.h>
 #include <unordered_map>
-#include <unordered_set>
 
 namespace mold::elf {
 
@@ -63,23 +68,37 @@ public:
   RObjectFile<E> &file;
 };
 
+// A global symbol in an output symbol table. If the same symbol name
+// appears in multiple input files, the one with the smallest rank wins.
+// A definition always has a smaller rank than an undefined symbol, and
+// among definitions (or among undefined symbols), the first one in the
+// command line order wins.
+template <typename E>
+struct RSymbol {
+  RObjectFile<E> *file = nullptr;
+  i64 sym_idx = 0;
+  u64 rank = -1;
+  i64 out_idx = 0;
+};
+
 template <typename E>
 class RSymtabSection : public RChunk<E> {
 public:
-  RSymtabSection() {
+  RSymtabSection(std::span<std::unique_ptr<RObjectFile<E>>> files)
+    : files(files) {
     this->name = ".symtab";
     this->out_shdr.sh_type = SHT_SYMTAB;
     this->out_shdr.sh_entsize = sizeof(ElfSym<E>);
     this->out_shdr.sh_addralign = E::word_size;
   }
 
-  void add_local_symbol(Context<E> &ctx, RObjectFile<E> &file, i64 idx);
-  void add_global_symbol(Context<E> &ctx, RObjectFile<E> &file, i64 idx);
+  void compute_symtab(Context<E> &ctx);
   void update_shdr(Context<E> &ctx) override;
   void write_to(Context<E> &ctx) override;
 
-  std::unordered_map<std::string_view, i64> sym_map;
-  std::vector<ElfSym<E>> syms{1};
+  std::span<std::unique_ptr<RObjectFile<E>>> files;
+  tbb::concurrent_hash_map<std::string_view, RSymbol<E>> sym_map;
+  ConcurrentMap<StrtabEntry> strtab_map;
 };
 
 template <typename E>
@@ -121,87 +140,170 @@ public:
 template <typename E>
 class RObjectFile {
 public:
-  RObjectFile(Context<E> &ctx, MappedFile<Context<E>> &mf, bool is_alive);
+  RObjectFile(Context<E> &ctx, MappedFile<Context<E>> &mf, u32 priority,
+              bool is_alive);
 
-  void remove_comdats(Context<E> &ctx,
-                      std::unordered_set<std::string_view> &groups);
+  void read_comdat_groups(Context<E> &ctx);
+  void eliminate_duplicate_comdat_groups(Context<E> &ctx);
+  void resolve_symbols(Context<E> &ctx);
+  void compute_symtab(Context<E> &ctx);
+  void assign_symtab_indices(Context<E> &ctx);
+  void write_symtab(Context<E> &ctx);
 
   template <typename T>
   std::span<T> get_data(Context<E> &ctx, const ElfShdr<E> &shdr);
 
+  // Returns true if a given symbol is defined by a section that is
+  // copied to the output file.
+  bool is_live_def(const ElfSym<E> &sym) const {
+    return sym.is_abs() || sym.is_common() ||
+           (!sym.is_undef() && sections[sym.st_shndx]);
+  }
+
+  bool is_owner(i64 idx) const {
+    RSymbol<E> *sym = global_syms[idx - first_global];
+    return sym->file == this && sym->sym_idx == idx;
+  }
+
   MappedFile<Context<E>> &mf;
   std::span<ElfShdr<E>> elf_sections;
   std::vector<std::unique_ptr<RInputSection<E>>> sections;
   std::span<const ElfSym<E>> syms;
   std::vector<i64> symidx;
-  std::unordered_set<std::string_view> defined_syms;
-  std::unordered_set<std::string_view> undef_syms;
+  std::vector<RSymbol<E> *> global_syms;
+  std::vector<StrtabEntry *> strtab_entries;
+  std::vector<std::pair<ComdatGroup *, i64>> comdat_groups;
   i64 symtab_shndx = 0;
   i64 first_global = 0;
-  bool is_alive;
+  u32 priority;
+  std::atomic_bool is_alive;
   const char *strtab = nullptr;
   const char *shstrtab = nullptr;
+
+  i64 local_symtab_offset = 0;
+  i64 global_symtab_offset = 0;
+  i64 num_local_symtab = 0;
+  i64 num_global_symtab = 0;
+  i64 strtab_offset = 0;
+  i64 strtab_size = 0;
 };
 
+// Computes the size of the output symbol table and assigns output
+// symbol indices to input symbols. Each file computes its own part
+// independently, and then we compute per-file offsets with prefix sums.
 template <typename E>
-void RSymtabSection<E>::add_local_symbol(Context<E> &ctx, RObjectFile<E> &file,
-                                         i64 idx) {
-  ElfSym<E> sym = file.syms[idx];
-  assert(sym.st_bind == STB_LOCAL);
-
-  if (!sym.is_undef() && !sym.is_abs() && !sym.is_common()) {
-    if (!file.sections[sym.st_shndx])
-      return;
-    sym.st_shndx = file.sections[sym.st_shndx]->shndx;
-  }
+void RSymtabSection<E>::compute_symtab(Context<E> &ctx) {
+  Timer t(ctx, "compute_symtab");
 
-  std::string_view name = file.strtab + sym.st_name;
-  sym.st_name = ctx.r_strtab->add_string(name);
+  tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+    file->compute_symtab(ctx);
+  });
 
-  file.symidx[idx] = syms.size();
-  syms.push_back(sym);
-}
+  // Local symbols must precede global ones in a symbol table.
+  i64 idx = 1;
+  for (std::unique_ptr<RObjectFile<E>> &file : files) {
+    file->local_symtab_offset = idx;
+    idx += file->num_local_symtab;
+  }
 
-template <typename E>
-void RSymtabSection<E>::add_global_symbol(Context<E> &ctx, RObjectFile<E> &file,
-                                          i64 idx) {
-  ElfSym<E> sym = file.syms[idx];
-  assert(sym.st_bind != STB_LOCAL);
-
-  std::string_view name = file.strtab + sym.st_name;
-  auto [it, inserted] = sym_map.insert({name, syms.size()});
-
-  if (inserted) {
-    if (!sym.is_undef() && !sym.is_abs() && !sym.is_common())
-      sym.st_shndx = file.sections[sym.st_shndx]->shndx;
-    sym.st_name = ctx.r_strtab->add_string(name);
-    file.symidx[idx] = syms.size();
-    syms.push_back(sym);
-    return;
+  this->out_shdr.sh_info = idx;
+
+  for (std::unique_ptr<RObjectFile<E>> &file : files) {
+    file->global_symtab_offset = idx;
+    idx += file->num_global_symtab;
   }
 
-  file.symidx[idx] = it->second;
+  this->out_shdr.sh_size = idx * sizeof(ElfSym<E>);
+
+  tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+    file->assign_symtab_indices(ctx);
+  });
+
+  // Symbol names are deduplicated in the same way as in a regular
+  // link. The first occurrence of each name owns the string, and
+  // the other symbols with the same name refer to it.
+  strtab_map.resize(idx * 3 / 2);
+
+  tbb::parallel_for((i64)0, (i64)files.size(), [&](i64 i) {
+    RObjectFile<E> &file = *files[i];
+    file.strtab_entries.reserve(file.num_local_symtab + file.num_global_symtab);
+
+    auto add = [&](i64 idx) {
+      std::string_view name = file.strtab + file.syms[idx].st_name;
+      if (name.empty()) {
+        file.strtab_entries.push_back(nullptr);
+        return;
+      }
+
+      StrtabEntry *ent =
+        strtab_map.insert(name, hash_string(name), StrtabEntry()).first;
+      update_minimum(ent->owner, (i << 32) | file.strtab_entries.size());
+      file.strtab_entries.push_back(ent);
+    };
+
+    for (i64 j = 1; j < file.first_global; j++)
+      if (file.symidx[j])
+        add(j);
+
+    for (i64 j = file.first_global; j < file.syms.size(); j++)
+      if (file.is_owner(j))
+        add(j);
+  });
+
+  auto is_owner = [](i64 i, i64 j, StrtabEntry *ent) {
+    return ent && ent->owner == ((i << 32) | j);
+  };
+
+  auto get_size = [&](StrtabEntry *ent) {
+    return strtab_map.sizes[ent - strtab_map.values] + 1;
+  };
+
+  tbb::parallel_for((i64)0, (i64)files.size(), [&](i64 i) {
+    RObjectFile<E> &file = *files[i];
+    for (i64 j = 0; j < file.strtab_entries.size(); j++)
+      if (StrtabEntry *ent = file.strtab_entries[j]; is_owner(i, j, ent))
+        file.strtab_size += get_size(ent);
+  });
 
-  ElfSym<E> &existing = syms[it->second];
-  if (existing.is_undef() && !sym.is_undef()) {
-    if (!sym.is_abs() && !sym.is_common())
-      sym.st_shndx = file.sections[sym.st_shndx]->shndx;
-    sym.st_name = existing.st_name;
-    existing = sym;
+  i64 offset = 1;
+  for (std::unique_ptr<RObjectFile<E>> &file : files) {
+    file->strtab_offset = offset;
+    offset += file->strtab_size;
   }
+
+  ctx.r_strtab->out_shdr.sh_size = offset;
+
+  tbb::parallel_for((i64)0, (i64)files.size(), [&](i64 i) {
+    RObjectFile<E> &file = *files[i];
+    i64 off = file.strtab_offset;
+    for (i64 j = 0; j < file.strtab_entries.size(); j++) {
+      if (StrtabEntry *ent = file.strtab_entries[j]; is_owner(i, j, ent)) {
+        ent->offset = off;
+        off += get_size(ent);
+      }
+    }
+  });
+
+  // Now that all global symbols have output indices, we can fill in
+  // the index mapping for non-owner references.
+  tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+    for (i64 i = file->first_global; i < file->syms.size(); i++)
+      file->symidx[i] = file->global_syms[i - file->first_global]->out_idx;
+  });
 }
 
 template <typename E>
 void RSymtabSection<E>::update_shdr(Context<E> &ctx) {
-  this->out_shdr.sh_size = syms.size() * sizeof(ElfSym<E>);
   this->out_shdr.sh_link = ctx.r_strtab->shndx;
 }
 
 template <typename E>
 void RSymtabSection<E>::write_to(Context<E> &ctx) {
-  ElfSym<E> *buf = (ElfSym<E> *)(ctx.buf + this->out_shdr.sh_offset);
-  for (i64 i = 1; i < syms.size(); i++)
-    buf[i] = syms[i];
+  memset(ctx.buf + this->out_shdr.sh_offset, 0, sizeof(ElfSym<E>));
+
+  tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+    file->write_symtab(ctx);
+  });
 }
 
 template <typename E>
@@ -228,7 +330,7 @@ void RInputSection<E>::update_shdr(Context<E> &ctx) {
   default:
     if (this->in_shdr.sh_link) {
       std::unique_ptr<RInputSection<E>> &sec =
-        file.sections[this->in_shdr.sh_info];
+        file.sections[this->in_shdr.sh_link];
 
       if (sec)
         this->out_shdr.sh_link = sec->shndx;
@@ -258,11 +360,13 @@ void RInputSection<E>::write_to(Context<E> &ctx) {
     ElfRel<E> *rel = (ElfRel<E> *)(ctx.buf + this->out_shdr.sh_offset);
     i64 size = this->out_shdr.sh_size / sizeof(ElfRel<E>);
 
+    // Global symbols are always copied to the output, but local
+    // symbols are not if they belong to eliminated sections.
+    // Relocations referring such symbols are removed.
     for (i64 i = 0; i < size; i++) {
-      const ElfSym<E> &sym = file.syms[rel[i].r_sym];
-      if (sym.is_undef() || sym.is_abs() || sym.is_common() ||
-          file.sections[sym.st_shndx])
-        rel[i].r_sym = file.symidx[rel[i].r_sym];
+      i64 sym = rel[i].r_sym;
+      if (sym == 0 || sym >= file.first_global || file.symidx[sym])
+        rel[i].r_sym = file.symidx[sym];
       else
         memset(rel + i, 0, sizeof(ElfRel<E>));
     }
@@ -289,13 +393,16 @@ i64 RStrtabSection<E>::add_string(std::string_view str) {
 
 template <typename E>
 void RStrtabSection<E>::write_to(Context<E> &ctx) {
+  u8 *buf = ctx.buf + this->out_shdr.sh_offset;
+  buf[0] = '\0';
   for (auto [str, offset] : strings)
-    memcpy(ctx.buf + this->out_shdr.sh_offset + offset, str.data(), str.size());
+    write_string(buf + offset, str);
 }
 
 template <typename E>
 void ROutputEhdr<E>::write_to(Context<E> &ctx) {
   ElfEhdr<E> &hdr = *(ElfEhdr<E> *)(ctx.buf + this->out_shdr.sh_offset);
+  memset(&hdr, 0, sizeof(hdr));
   memcpy(&hdr.e_ident, "\177ELF", 4);
   hdr.e_ident[EI_CLASS] = (E::word_size == 8) ? ELFCLASS64 : ELFCLASS32;
   hdr.e_ident[EI_DATA] = E::is_le ? ELFDATA2LSB : ELFDATA2MSB;
@@ -321,6 +428,7 @@ void ROutputShdr<E>::update_shdr(Context<E> &ctx) {
 template <typename E>
 void ROutputShdr<E>::write_to(Context<E> &ctx) {
   ElfShdr<E> *hdr = (ElfShdr<E> *)(ctx.buf + this->out_shdr.sh_offset);
+  memset(hdr, 0, sizeof(ElfShdr<E>));
   for (RChunk<E> *chunk : ctx.r_chunks)
     if (chunk->shndx)
       hdr[chunk->shndx] = chunk->out_shdr;
@@ -328,8 +436,8 @@ void ROutputShdr<E>::write_to(Context<E> &ctx) {
 
 template <typename E>
 RObjectFile<E>::RObjectFile(Context<E> &ctx, MappedFile<Context<E>> &mf,
-                            bool is_alive)
-  : mf(mf), is_alive(is_alive) {
+                            u32 priority, bool is_alive)
+  : mf(mf), priority(priority), is_alive(is_alive) {
   // Read ELF header and section header
   ElfEhdr<E> &ehdr = *(ElfEhdr<E> *)mf.data;
   ElfShdr<E> *sh_begin = (ElfShdr<E> *)(mf.data + ehdr.e_shoff);
@@ -368,41 +476,128 @@ RObjectFile<E>::RObjectFile(Context<E> &ctx, MappedFile<Context<E>> &mf,
       sections[i].reset(new RInputSection(ctx, *this, shdr));
     }
   }
-
-  // Read global symbols
-  for (i64 i = first_global; i < syms.size(); i++) {
-    std::string_view name = strtab + syms[i].st_name;
-    if (syms[i].is_defined())
-      defined_syms.insert(name);
-    else
-      undef_syms.insert(name);
-  }
 }
 
-// Remove duplicate comdat groups
 template <typename E>
-void RObjectFile<E>::remove_comdats(Context<E> &ctx,
-                                    std::unordered_set<std::string_view> &groups) {
+void RObjectFile<E>::read_comdat_groups(Context<E> &ctx) {
   for (i64 i = 1; i < sections.size(); i++) {
-    if (!sections[i])
-      continue;
-    ElfShdr<E> &shdr = sections[i]->in_shdr;
-    if (shdr.sh_type != SHT_GROUP)
+    if (!sections[i] || sections[i]->in_shdr.sh_type != SHT_GROUP)
       continue;
 
-    // Get a comdat group signature and insert it into a set.
-    const ElfSym<E> &sym = syms[shdr.sh_info];
+    // Get a comdat group signature and insert it into a global map.
+    // The group owned by the first file in the command line wins.
+    const ElfSym<E> &sym = syms[sections[i]->in_shdr.sh_info];
     std::string_view signature = strtab + sym.st_name;
-    if (groups.insert(signature).second)
+
+    typename decltype(ctx.comdat_groups)::const_accessor acc;
+    ctx.comdat_groups.insert(acc, {signature, ComdatGroup()});
+    ComdatGroup *group = const_cast<ComdatGroup *>(&acc->second);
+    comdat_groups.push_back({group, i});
+    update_minimum(group->owner, priority);
+  }
+}
+
+// Remove duplicate comdat groups
+template <typename E>
+void RObjectFile<E>::eliminate_duplicate_comdat_groups(Context<E> &ctx) {
+  for (auto [group, shndx] : comdat_groups) {
+    if (group->owner == priority)
       continue;
 
     // If it is a duplicate, remove it and its members.
-    for (i64 j : this->template get_data<u32>(ctx, shdr).subspan(1))
+    for (i64 j : this->template get_data<u32>(ctx, elf_sections[shndx]).subspan(1))
       sections[j] = nullptr;
-    sections[i] = nullptr;
+    sections[shndx] = nullptr;
   }
 }
 
+template <typename E>
+void RObjectFile<E>::resolve_symbols(Context<E> &ctx) {
+  global_syms.resize(syms.size() - first_global);
+
+  for (i64 i = first_global; i < syms.size(); i++) {
+    const ElfSym<E> &esym = syms[i];
+    std::string_view name = strtab + esym.st_name;
+    u64 rank = ((u64)!is_live_def(esym) << 62) | ((u64)priority << 32) | i;
+
+    typename decltype(ctx.r_symtab->sym_map)::accessor acc;
+    ctx.r_symtab->sym_map.insert(acc, {name, RSymbol<E>()});
+    RSymbol<E> &sym = acc->second;
+
+    if (rank < sym.rank) {
+      sym.file = this;
+      sym.sym_idx = i;
+      sym.rank = rank;
+    }
+    global_syms[i - first_global] = &sym;
+  }
+}
+
+template <typename E>
+void RObjectFile<E>::compute_symtab(Context<E> &ctx) {
+  for (i64 i = 1; i < first_global; i++)
+    if (is_live_def(syms[i]) || syms[i].is_undef())
+      num_local_symtab++;
+
+  for (i64 i = first_global; i < syms.size(); i++)
+    if (is_owner(i))
+      num_global_symtab++;
+}
+
+template <typename E>
+void RObjectFile<E>::assign_symtab_indices(Context<E> &ctx) {
+  i64 idx = local_symtab_offset;
+  for (i64 i = 1; i < first_global; i++)
+    if (is_live_def(syms[i]) || syms[i].is_undef())
+      symidx[i] = idx++;
+
+  idx = global_symtab_offset;
+  for (i64 i = first_global; i < syms.size(); i++)
+    if (is_owner(i))
+      global_syms[i - first_global]->out_idx = idx++;
+}
+
+template <typename E>
+void RObjectFile<E>::write_symtab(Context<E> &ctx) {
+  ElfSym<E> *symtab_base =
+    (ElfSym<E> *)(ctx.buf + ctx.r_symtab->out_shdr.sh_offset);
+  u8 *strtab_base = ctx.buf + ctx.r_strtab->out_shdr.sh_offset;
+  i64 entry_idx = 0;
+
+  auto write_sym = [&](i64 idx) {
+    ElfSym<E> esym = syms[idx];
+    std::string_view name = strtab + esym.st_name;
+
+    if (is_live_def(esym)) {
+      if (!esym.is_abs() && !esym.is_common())
+        esym.st_shndx = sections[esym.st_shndx]->shndx;
+    } else if (!esym.is_undef()) {
+      // A global symbol defined in an eliminated section is written as
+      // an undefined symbol if there's no other definition.
+      esym.st_shndx = SHN_UNDEF;
+      esym.st_value = 0;
+      esym.st_size = 0;
+    }
+
+    // A symbol name is written by the file that owns the string.
+    // Other files just refer to it.
+    StrtabEntry *ent = strtab_entries[entry_idx++];
+    esym.st_name = ent ? ent->offset : 0;
+    if (strtab_offset <= esym.st_name &&
+        esym.st_name < strtab_offset + strtab_size)
+      write_string(strtab_base + esym.st_name, name);
+    symtab_base[symidx[idx]] = esym;
+  };
+
+  for (i64 i = 1; i < first_global; i++)
+    if (symidx[i])
+      write_sym(i);
+
+  for (i64 i = first_global; i < syms.size(); i++)
+    if (is_owner(i))
+      write_sym(i);
+}
+
 template <typename E>
 template <typename T>
 std::span<T> RObjectFile<E>::get_data(Context<E> &ctx, const ElfShdr<E> &shdr) {
@@ -414,7 +609,9 @@ std::span<T> RObjectFile<E>::get_data(Context<E> &ctx, const ElfShdr<E> &shdr) {
 template <typename E>
 static std::vector<std::unique_ptr<RObjectFile<E>>>
 open_files(Context<E> &ctx, std::span<std::string_view> args) {
-  std::vector<std::unique_ptr<RObjectFile<E>>> files;
+  Timer t(ctx, "open_files");
+
+  std::vector<std::pair<MappedFile<Context<E>> *, bool>> mfs;
   bool whole_archive = false;
 
   while (!args.empty()) {
@@ -447,83 +644,119 @@ open_files(Context<E> &ctx, std::span<std::string_view> args) {
 
     switch (get_file_type(mf)) {
     case FileType::ELF_OBJ:
-      files.emplace_back(new RObjectFile<E>(ctx, *mf, true));
+      mfs.push_back({mf, true});
       break;
     case FileType::AR:
     case FileType::THIN_AR:
       for (MappedFile<Context<E>> *child : read_archive_members(ctx, mf))
         if (get_file_type(child) == FileType::ELF_OBJ)
-          files.emplace_back(new RObjectFile<E>(ctx, *child, whole_archive));
+          mfs.push_back({child, whole_archive});
       break;
     default:
       break;
     }
   }
+
+  // Parse files in parallel. A file's index is used as its priority.
+  std::vector<std::unique_ptr<RObjectFile<E>>> files(mfs.size());
+  tbb::parallel_for((i64)0, (i64)mfs.size(), [&](i64 i) {
+    files[i].reset(new RObjectFile<E>(ctx, *mfs[i].first, i, mfs[i].second));
+  });
   return files;
 }
 
+// Archive members are included only when they define symbols that are
+// referenced by other included files. We first build a map from symbol
+// names to their defining files, and then traverse the file graph in
+// parallel starting from the files that are unconditionally included.
+template <typename E>
+static void mark_live_objects(Context<E> &ctx,
+                              std::span<std::unique_ptr<RObjectFile<E>>> files) {
+  Timer t(ctx, "mark_live_objects");
+
+  tbb::concurrent_hash_map<std::string_view, RObjectFile<E> *> definers;
+
+  auto is_better = [](RObjectFile<E> *a, RObjectFile<E> *b) {
+    return std::tuple(!a->is_alive, a->priority) <
+           std::tuple(!b->is_alive, b->priority);
+  };
+
+  tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+    for (i64 i = file->first_global; i < file->syms.size(); i++) {
+      const ElfSym<E> &esym = file->syms[i];
+      if (esym.is_undef())
+        continue;
+
+      typename decltype(definers)::accessor acc;
+      if (!definers.insert(acc, {file->strtab + esym.st_name, file.get()}) &&
+          is_better(file.get(), acc->second))
+        acc->second = file.get();
+    }
+  });
+
+  std::vector<RObjectFile<E> *> roots;
+  for (std::unique_ptr<RObjectFile<E>> &file : files)
+    if (file->is_alive)
+      roots.push_back(file.get());
+
+  tbb::parallel_for_each(roots, [&](RObjectFile<E> *file,
+                                    tbb::feeder<RObjectFile<E> *> &feeder) {
+    for (i64 i = file->first_global; i < file->syms.size(); i++) {
+      const ElfSym<E> &esym = file->syms[i];
+      if (!esym.is_undef() || esym.is_weak())
+        continue;
+
+      typename decltype(definers)::const_accessor acc;
+      if (definers.find(acc, file->strtab + esym.st_name) &&
+          !acc->second->is_alive.exchange(true))
+        feeder.add(acc->second);
+    }
+  });
+}
+
 template <typename E>
 static i64 assign_offsets(Context<E> &ctx) {
   i64 offset = 0;
   for (RChunk<E> *chunk : ctx.r_chunks) {
     offset = align_to(offset, chunk->out_shdr.sh_addralign);
     chunk->out_shdr.sh_offset = offset;
-    offset += chunk->out_shdr.sh_size;
+    if (chunk->out_shdr.sh_type != SHT_NOBITS)
+      offset += chunk->out_shdr.sh_size;
   }
   return offset;
 }
 
-static bool contains(std::unordered_set<std::string_view> &a,
-                     std::unordered_set<std::string_view> &b) {
-  for (std::string_view x : b)
-    if (a.contains(x))
-      return true;
-  return false;
-}
-
 template <typename E>
 void combine_objects(Context<E> &ctx, std::span<std::string_view> file_args) {
+  Timer t(ctx, "combine_objects");
+
   // Read object files
   std::vector<std::unique_ptr<RObjectFile<E>>> files = open_files(ctx, file_args);
 
   // Identify needed objects
-  std::unordered_set<std::string_view> undef_syms;
-  auto add_syms = [&](RObjectFile<E> &file) {
-    undef_syms.insert(file.undef_syms.begin(), file.undef_syms.end());
-    for (std::string_view name : file.defined_syms)
-      undef_syms.erase(name);
-    file.is_alive = true;
-  };
-
-  for (std::unique_ptr<RObjectFile<E>> &file : files)
-    if (file->is_alive)
-      add_syms(*file);
-
-  for (;;) {
-    bool added = false;
-    for (std::unique_ptr<RObjectFile<E>> &file : files) {
-      if (!file->is_alive && contains(undef_syms, file->defined_syms)) {
-        add_syms(*file);
-        added = true;
-      }
-    }
-    if (!added)
-      break;
-  }
+  mark_live_objects<E>(ctx, files);
 
   std::erase_if(files, [](std::unique_ptr<RObjectFile<E>> &file) {
     return !file->is_alive;
   });
 
   // Remove duplicate comdat groups
-  std::unordered_set<std::string_view> comdat_groups;
-  for (std::unique_ptr<RObjectFile<E>> &file : files)
-    file->remove_comdats(ctx, comdat_groups);
+  {
+    Timer t(ctx, "eliminate_comdats");
+
+    tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+      file->read_comdat_groups(ctx);
+    });
+
+    tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+      file->eliminate_duplicate_comdat_groups(ctx);
+    });
+  }
 
   // Create headers and linker-synthesized sections
   ROutputEhdr<E> ehdr;
   ROutputShdr<E> shdr;
-  RSymtabSection<E> symtab;
+  RSymtabSection<E> symtab(files);
   RStrtabSection<E> shstrtab(".shstrtab");
   RStrtabSection<E> strtab(".strtab");
 
@@ -557,31 +790,47 @@ void combine_objects(Context<E> &ctx, std::span<std::string_view> file_args) {
     if (chunk->shndx)
       chunk->out_shdr.sh_name = shstrtab.add_string(chunk->name);
 
-  // Copy symbols from input objects to an output object
-  for (std::unique_ptr<RObjectFile<E>> &file : files)
-    for (i64 i = 1; i < file->first_global; i++)
-      symtab.add_local_symbol(ctx, *file, i);
-
-  symtab.out_shdr.sh_info = symtab.syms.size();
+  // Resolve global symbols
+  {
+    Timer t(ctx, "resolve_symbols");
+    tbb::parallel_for_each(files, [&](std::unique_ptr<RObjectFile<E>> &file) {
+      file->resolve_symbols(ctx);
+    });
+  }
 
-  for (std::unique_ptr<RObjectFile<E>> &file : files)
-    for (i64 i = file->first_global; i < file->syms.size(); i++)
-      symtab.add_global_symbol(ctx, *file, i);
+  // Compute .symtab and .strtab sizes and symbol indices
+  symtab.compute_symtab(ctx);
 
   // Finalize section header
-  for (RChunk<E> *chunk : ctx.r_chunks)
+  tbb::parallel_for_each(ctx.r_chunks, [&](RChunk<E> *chunk) {
     chunk->update_shdr(ctx);
+  });
 
   // Open an output file
   i64 filesize = assign_offsets(ctx);
   std::unique_ptr<OutputFile<E>> out =
     OutputFile<E>::open(ctx, ctx.arg.output, filesize, 0666);
-  memset(out->buf, 0, filesize);
   ctx.buf = out->buf;
 
-  // Write to the output file
-  for (RChunk<E> *chunk : ctx.r_chunks)
-    chunk->write_to(ctx);
+  // Write to the output file. Since we don't clear the entire output
+  // buffer beforehand, each chunk zero-clears the padding that follows.
+  {
+    Timer t(ctx, "write_output");
+
+    tbb::parallel_for((i64)0, (i64)ctx.r_chunks.size(), [&](i64 i) {
+      RChunk<E> *chunk = ctx.r_chunks[i];
+      chunk->write_to(ctx);
+
+      i64 end = chunk->out_shdr.sh_offset;
+      if (chunk->out_shdr.sh_type != SHT_NOBITS)
+        end += chunk->out_shdr.sh_size;
+
+      i64 next = (i + 1 < ctx.r_chunks.size())
+        ? ctx.r_chunks[i + 1]->out_shdr.sh_offset : filesize;
+      memset(ctx.buf + end, 0, next - end);
+    });
+  }
+
   out->close(ctx);
 }
 
@@ -157,6 +157,14 @@ private:
 // Utility functions
 //
 
+// Returns log2 of a given alignment. Alignment 0 is treated as 1.
+inline u8 to_p2align(u64 align) {
+  if (align == 0)
+    return 0;
+  assert(__builtin_popcountll(align) == 1);
+  return __builtin_ctzll(align);
+}
+
 inline u64 align_to(u64 val, u64 align) {
   if (align == 0)
     return val;
@@ -258,6 +266,28 @@ inline u64 read_uleb(u8 *&buf) {
   return val;
 }
 
+inline void encode_sleb(std::vector<u8> &vec, i64 val) {
+  for (;;) {
+    u8 byte = val & 0x7f;
+    val >>= 7;
+    if ((val == 0 && !(byte & 0x40)) || (val == -1 && (byte & 0x40))) {
+      vec.push_back(byte);
+      return;
+    }
+    vec.push_back(byte | 0x80);
+  }
+}
+
+// Writes a value in signed LEB128 padded to exactly `size` bytes,
+// so that a placeholder can be overwritten later.
+inline void write_padded_sleb(u8 *buf, i64 val, i64 size) {
+  for (i64 i = 0; i < size - 1; i++) {
+    buf[i] = (val & 0x7f) | 0x80;
+    val >>= 7;
+  }
+  buf[size - 1] = val & 0x7f;
+}
+
 inline i64 uleb_size(u64 val) {
   i64 i = 0;
   do {
@@ -408,6 +438,72 @@ private:
   std::unique_ptr<u8[]> vec = nullptr;
 };
 
+//
+// Arena
+//
+
+// Arena is a bump-pointer allocator for objects of type T. Objects are
+// carved out of large blocks which are released all at once when the
+// arena is destroyed, so allocating millions of small objects doesn't
+// hit malloc for each of them.
+//
+// Releasing an arena frees its blocks in bulk. If T is trivially
+// destructible, that takes time proportional to the number of blocks
+// and not to the number of objects. Otherwise, we have to run ~T() for
+// each object so that memory owned by objects (e.g. vectors in
+// InputSection) is not leaked. The linker normally skips the whole
+// teardown by calling _exit() unless --no-quick-exit is given.
+//
+// Arena is not thread-safe. We usually have one arena per input file.
+template <typename T>
+class Arena {
+public:
+  Arena() = default;
+  Arena(const Arena &) = delete;
+
+  ~Arena() {
+    for (Block &b : blocks) {
+      if constexpr (!std::is_trivially_destructible_v<T>)
+        for (i64 i = 0; i < b.size; i++)
+          b.data[i].~T();
+      ::operator delete(b.data, std::align_val_t(alignof(T)));
+    }
+  }
+
+  // Make sure that the next `n` objects are allocated from the same
+  // block.
+  void reserve(i64 n) {
+    if (blocks.empty() || blocks.back().capacity - blocks.back().size < n)
+      add_block(n);
+  }
+
+  template <typename... Args>
+  T *alloc(Args &&...args) {
+    if (blocks.empty() || blocks.back().size == blocks.back().capacity)
+      add_block(blocks.empty() ? 8 : std::min<i64>(blocks.back().capacity * 2, 4096));
+
+    Block &b = blocks.back();
+    T *obj = new (b.data + b.size) T(std::forward<Args>(args)...);
+    b.size++;
+    return obj;
+  }
+
+private:
+  struct Block {
+    T *data;
+    i64 size;
+    i64 capacity;
+  };
+
+  void add_block(i64 capacity) {
+    T *data = (T *)::operator new(sizeof(T) * capacity,
+                                  std::align_val_t(alignof(T)));
+    blocks.push_back({data, 0, capacity});
+  }
+
+  std::vector<Block> blocks;
+};
+
 //
 // threads.cc
 //
@@ -537,7 +633,13 @@ struct TimerRecord {
   i64 end;
   i64 user;
   i64 sys;
+  i64 dtlb_misses = -1;
   bool stopped = false;
+
+  // If true, we also record the number of data TLB misses for each
+  // timer. It is enabled by --perf because reading a hardware counter
+  // needs a system call.
+  static inline bool count_dtlb_misses = false;
 };
 
 void
@@ -655,6 +757,24 @@ MappedFile<C> *MappedFile<C>::open(C &ctx, std::string path) {
   return mf;
 }
 
+// Ask the kernel to back a given memory region with transparent huge
+// pages. This is just a hint; the kernel may or may not honor it
+// depending on the system configuration and the type of memory region.
+inline void madvise_huge_pages(void *addr, i64 size) {
+#ifdef MADV_HUGEPAGE
+  // Regions smaller than a huge page cannot benefit from it.
+  if (size < (2 << 20))
+    return;
+
+  // madvise(2) fails with EINVAL if a given address is not page-aligned,
+  // which is the case for archive members. Round it down to a page
+  // boundary. The extra bytes belong to the same mapping.
+  static u64 page_size = sysconf(_SC_PAGESIZE);
+  u64 begin = align_down((u64)addr, page_size);
+  madvise((void *)begin, (u64)addr + size - begin, MADV_HUGEPAGE);
+#endif
+}
+
 template <typename C>
 MappedFile<C> *MappedFile<C>::must_open(C &ctx, std::string path) {
   if (MappedFile *mf = MappedFile::open(ctx, path))
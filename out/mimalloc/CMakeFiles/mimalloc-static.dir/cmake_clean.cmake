@@ -0,0 +1,37 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mimalloc-static.dir/src/alloc-aligned.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/alloc-aligned.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/alloc-posix.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/alloc-posix.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/alloc.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/alloc.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/arena.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/arena.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/bitmap.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/bitmap.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/heap.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/heap.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/init.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/init.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/options.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/options.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/os.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/os.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/page.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/page.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/random.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/random.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/segment-cache.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/segment-cache.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/segment.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/segment.c.o.d"
+  "CMakeFiles/mimalloc-static.dir/src/stats.c.o"
+  "CMakeFiles/mimalloc-static.dir/src/stats.c.o.d"
+  "libmimalloc.a"
+  "libmimalloc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/mimalloc-static.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/mimalloc-test-api.dir/test/test-api.c.o"
+  "CMakeFiles/mimalloc-test-api.dir/test/test-api.c.o.d"
+  "mimalloc-test-api"
+  "mimalloc-test-api.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/mimalloc-test-api.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,10 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/third-party/mimalloc
+# Build directory: /root/repo/out/mimalloc
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(test_api, "mimalloc-test-api")
+set_tests_properties(test_api, PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/third-party/mimalloc/CMakeLists.txt;392;add_test;/root/repo/third-party/mimalloc/CMakeLists.txt;0;")
+add_test(test_stress, "mimalloc-test-stress")
+set_tests_properties(test_stress, PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/third-party/mimalloc/CMakeLists.txt;393;add_test;/root/repo/third-party/mimalloc/CMakeLists.txt;0;")
@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "../../gnu_12.2_cxx11_64_relwithdebinfo/libtbb.a"
+)
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "../../gnu_12.2_cxx11_64_relwithdebinfo/libtbbbind_2_5.a"
+  "../../gnu_12.2_cxx11_64_relwithdebinfo/libtbbbind_2_5.pdb"
+  "CMakeFiles/tbbbind_2_5.dir/tbb_bind.cpp.o"
+  "CMakeFiles/tbbbind_2_5.dir/tbb_bind.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tbbbind_2_5.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
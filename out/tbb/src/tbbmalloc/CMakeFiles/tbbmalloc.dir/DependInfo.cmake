@@ -0,0 +1,24 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/third-party/tbb/src/tbb/itt_notify.cpp" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/__/tbb/itt_notify.cpp.o" "gcc" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/__/tbb/itt_notify.cpp.o.d"
+  "/root/repo/third-party/tbb/src/tbbmalloc/backend.cpp" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/backend.cpp.o" "gcc" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/backend.cpp.o.d"
+  "/root/repo/third-party/tbb/src/tbbmalloc/backref.cpp" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/backref.cpp.o" "gcc" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/backref.cpp.o.d"
+  "/root/repo/third-party/tbb/src/tbbmalloc/frontend.cpp" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/frontend.cpp.o" "gcc" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/frontend.cpp.o.d"
+  "/root/repo/third-party/tbb/src/tbbmalloc/large_objects.cpp" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/large_objects.cpp.o" "gcc" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/large_objects.cpp.o.d"
+  "/root/repo/third-party/tbb/src/tbbmalloc/tbbmalloc.cpp" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/tbbmalloc.cpp.o" "gcc" "src/tbbmalloc/CMakeFiles/tbbmalloc.dir/tbbmalloc.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,21 @@
+file(REMOVE_RECURSE
+  "../../gnu_12.2_cxx11_64_relwithdebinfo/libtbbmalloc.a"
+  "../../gnu_12.2_cxx11_64_relwithdebinfo/libtbbmalloc.pdb"
+  "CMakeFiles/tbbmalloc.dir/__/tbb/itt_notify.cpp.o"
+  "CMakeFiles/tbbmalloc.dir/__/tbb/itt_notify.cpp.o.d"
+  "CMakeFiles/tbbmalloc.dir/backend.cpp.o"
+  "CMakeFiles/tbbmalloc.dir/backend.cpp.o.d"
+  "CMakeFiles/tbbmalloc.dir/backref.cpp.o"
+  "CMakeFiles/tbbmalloc.dir/backref.cpp.o.d"
+  "CMakeFiles/tbbmalloc.dir/frontend.cpp.o"
+  "CMakeFiles/tbbmalloc.dir/frontend.cpp.o.d"
+  "CMakeFiles/tbbmalloc.dir/large_objects.cpp.o"
+  "CMakeFiles/tbbmalloc.dir/large_objects.cpp.o.d"
+  "CMakeFiles/tbbmalloc.dir/tbbmalloc.cpp.o"
+  "CMakeFiles/tbbmalloc.dir/tbbmalloc.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tbbmalloc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
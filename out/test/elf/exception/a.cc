@@ -0,0 +1,8 @@
+int main() {
+  try {
+    throw 0;
+  } catch (int x) {
+    return x;
+  }
+  return 1;
+}
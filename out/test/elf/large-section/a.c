@@ -0,0 +1,2 @@
+char x1[3L << 30];
+char x2[3L << 30];
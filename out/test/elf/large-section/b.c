@@ -0,0 +1 @@
+char x3[16]; int main() { return 0; }
@@ -0,0 +1,13 @@
+.globl main
+main:
+  sub $8, %rsp
+  movabs $foo+5@SIZE, %rdi
+  call print64@PLT
+  add $8, %rsp
+  ret
+
+.data
+.globl foo
+.type foo, %object
+.size foo, 56
+foo:
@@ -0,0 +1,7 @@
+extern long ext_var;
+static long arr[50000] = {1, 2, 3};
+void print64(long);
+
+int main() {
+  print64(ext_var * 1000000 + arr[2]);
+}
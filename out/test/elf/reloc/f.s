@@ -0,0 +1,15 @@
+.globl main
+main:
+  sub $8, %rsp
+  add $8, %rsp
+  ret
+
+.section .foo, "", @progbits
+.zero 16
+foo:
+.quad bar
+
+.section .bar, "", @progbits
+.zero 24
+bar:
+.quad foo
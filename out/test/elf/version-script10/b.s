@@ -0,0 +1,7 @@
+.globl foo1, foo2, foo3
+foo1:
+  nop
+foo2:
+  nop
+foo3:
+  nop
@@ -0,0 +1,7 @@
+.globl foo, bar, baz
+foo:
+  nop
+bar:
+  nop
+baz:
+  nop
@@ -6,6 +6,11 @@
 #include <sys/resource.h>
 #include <sys/time.h>
 
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/syscall.h>
+#endif
+
 namespace mold {
 
 i64 Counter::get_value() {
@@ -32,6 +37,31 @@ static i64 to_nsec(struct timeval t) {
   return (i64)t.tv_sec * 1000000000 + t.tv_usec * 1000;
 }
 
+// Returns the number of data TLB misses of this process (including all
+// threads) so far, or -1 if the hardware counter is not available.
+static i64 get_dtlb_misses() {
+#ifdef __linux__
+  static i64 fd = [] {
+    perf_event_attr attr = {};
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (i64)syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+                        PERF_FLAG_FD_CLOEXEC);
+  }();
+
+  u64 val;
+  if (fd != -1 && read(fd, &val, sizeof(val)) == sizeof(val))
+    return val;
+#endif
+  return -1;
+}
+
 TimerRecord::TimerRecord(std::string name, TimerRecord *parent)
   : name(name), parent(parent) {
   struct rusage usage;
@@ -41,6 +71,9 @@ TimerRecord::TimerRecord(std::string name, TimerRecord *parent)
   user = to_nsec(usage.ru_utime);
   sys = to_nsec(usage.ru_stime);
 
+  if (count_dtlb_misses)
+    dtlb_misses = get_dtlb_misses();
+
   if (parent)
     parent->children.push_back(this);
 }
@@ -56,22 +89,28 @@ void TimerRecord::stop() {
   end = now_nsec();
   user = to_nsec(usage.ru_utime) - user;
   sys = to_nsec(usage.ru_stime) - sys;
+
+  if (dtlb_misses != -1)
+    dtlb_misses = get_dtlb_misses() - dtlb_misses;
 }
 
-static void print_rec(TimerRecord &rec, i64 indent) {
-  printf(" % 8.3f % 8.3f % 8.3f  %s%s\n",
+static void print_rec(TimerRecord &rec, i64 indent, bool show_dtlb) {
+  printf(" % 8.3f % 8.3f % 8.3f",
          ((double)rec.user / 1000000000),
          ((double)rec.sys / 1000000000),
-         (((double)rec.end - rec.start) / 1000000000),
-         std::string(indent * 2, ' ').c_str(),
-         rec.name.c_str());
+         (((double)rec.end - rec.start) / 1000000000));
+
+  if (show_dtlb)
+    printf(" % 12lld", (long long)rec.dtlb_misses);
+
+  printf("  %s%s\n", std::string(indent * 2, ' ').c_str(), rec.name.c_str());
 
   sort(rec.children, [](TimerRecord *a, TimerRecord *b) {
     return a->start < b->start;
   });
 
   for (TimerRecord *child : rec.children)
-    print_rec(*child, indent + 1);
+    print_rec(*child, indent + 1, show_dtlb);
 }
 
 void print_timer_records(
@@ -94,11 +133,16 @@ void print_timer_records(
     }
   }
 
-  std::cout << "     User   System     Real  Name\n";
+  bool show_dtlb = !records.empty() && records[0]->dtlb_misses != -1;
+
+  if (show_dtlb)
+    std::cout << "     User   System     Real    dTLB-miss  Name\n";
+  else
+    std::cout << "     User   System     Real  Name\n";
 
   for (std::unique_ptr<TimerRecord> &rec : records)
     if (!rec->parent)
-      print_rec(*rec, 0);
+      print_rec(*rec, 0, show_dtlb);
 
   std::cout << std::flush;
 }
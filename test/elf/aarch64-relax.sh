@@ -0,0 +1,75 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+[ "$(uname -m)" = x86_64 ] || { echo skipped; exit; }
+
+echo 'int main() {}' | aarch64-linux-gnu-gcc -o $t/exe -xc - >& /dev/null \
+  || { echo skipped; exit; }
+
+cat <<EOF | aarch64-linux-gnu-gcc -o $t/a.o -c -x assembler -
+  .globl get_foo, get_foo2, get_bar
+get_foo:
+  adrp x0, :got:foo
+  ldr x0, [x0, :got_lo12:foo]
+  ret
+get_foo2:
+  adrp x0, foo
+  add x0, x0, :lo12:foo
+  ret
+get_bar:
+  adrp x0, :got:bar
+  ldr x0, [x0, :got_lo12:bar]
+  ret
+
+  .data
+  .globl foo
+foo:
+  .word 3
+
+  .bss
+  .zero 0x200000
+  .globl bar
+bar:
+  .zero 4
+EOF
+
+cat <<EOF | aarch64-linux-gnu-gcc -o $t/b.o -c -xc -
+#include <stdio.h>
+
+int *get_foo();
+int *get_foo2();
+int *get_bar();
+
+int main() {
+  *get_bar() = 5;
+  printf("%d %d %d\n", *get_foo(), *get_foo2(), *get_bar());
+  return 0;
+}
+EOF
+
+aarch64-linux-gnu-gcc -B"`dirname "$mold"`" -o $t/exe $t/a.o $t/b.o -static
+qemu-aarch64 -L /usr/aarch64-linux-gnu $t/exe | grep -q '3 3 5'
+
+aarch64-linux-gnu-objdump -d $t/exe > $t/log
+grep -A3 '<get_foo>:' $t/log | grep -Eq 'adr\s+x0'
+grep -A3 '<get_foo2>:' $t/log | grep -Eq 'adr\s+x0'
+grep -A3 '<get_bar>:' $t/log | grep -Eq 'add\s+x0, x0'
+
+aarch64-linux-gnu-gcc -B"`dirname "$mold"`" -o $t/exe $t/a.o $t/b.o -static \
+  -Wl,--no-relax
+qemu-aarch64 -L /usr/aarch64-linux-gnu $t/exe | grep -q '3 3 5'
+
+aarch64-linux-gnu-objdump -d $t/exe > $t/log
+grep -A3 '<get_foo>:' $t/log | grep -Eq 'ldr\s+x0'
+grep -A3 '<get_foo2>:' $t/log | grep -Eq 'adrp\s+x0'
+
+echo OK
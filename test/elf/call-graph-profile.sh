@@ -0,0 +1,54 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+[ "$(uname -m)" = x86_64 ] || { echo skipped; exit; }
+
+cat <<EOF | $CC -o $t/a.o -c -xc -ffunction-sections -
+#include <stdio.h>
+
+void foo1() { printf("foo1 "); }
+void foo2() { printf("foo2 "); }
+void foo3() { printf("foo3 "); }
+void foo4() { printf("foo4 "); }
+
+int main() {
+  foo1();
+  foo2();
+  foo3();
+  foo4();
+  printf("\n");
+  return 0;
+}
+EOF
+
+# main calls foo4 100 times, and foo4 calls foo2 90 times.
+cat <<EOF | $CC -o $t/b.o -c -x assembler -
+  .section .llvm.call-graph-profile,"e",@0x6fff4c09
+  .reloc ., R_X86_64_NONE, main
+  .reloc ., R_X86_64_NONE, foo4
+  .quad 100
+  .reloc ., R_X86_64_NONE, foo4
+  .reloc ., R_X86_64_NONE, foo2
+  .quad 90
+EOF
+
+$CC -B. -o $t/exe $t/a.o $t/b.o
+$t/exe | grep -q 'foo1 foo2 foo3 foo4'
+
+nm -n $t/exe | grep -E ' (main|foo[1-4])$' | awk '{print $3}' | \
+  tr '\n' ' ' | grep -q '^main foo4 foo2 '
+
+$CC -B. -o $t/exe $t/a.o $t/b.o -Wl,--no-call-graph-profile-sort
+nm -n $t/exe | grep -E ' (main|foo[1-4])$' | awk '{print $3}' | \
+  tr '\n' ' ' | grep -q '^foo1 foo2 foo3 foo4 main $'
+
+echo OK
@@ -0,0 +1,48 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -c -g -o $t/a.o -xc -
+#include <stdio.h>
+
+int foo = 3;
+
+int main() {
+  printf("Hello world %d\n", foo);
+  return 0;
+}
+EOF
+
+# .debug_info refers to other debug sections and to .text with
+# absolute relocations, which are handled by the fast path of
+# apply_reloc_nonalloc.
+if [ "$(uname -m)" = x86_64 ]; then
+  readelf -W --relocs $t/a.o > $t/log
+  sed -n '/rela.debug_info/,/^$/p' $t/log | grep -q R_X86_64_32
+  sed -n '/rela.debug_info/,/^$/p' $t/log | grep -q R_X86_64_64
+fi
+
+$CC -B. -o $t/exe1 $t/a.o
+objcopy --dump-section .debug_info=$t/debug_info1 $t/exe1
+
+$CC -B. -o $t/exe2 $t/a.o -Wl,--compress-debug-sections=zlib
+$t/exe2 | grep -q 'Hello world 3'
+readelf -W --sections $t/exe2 | grep -Eq '\.debug_info .* C '
+
+objcopy --decompress-debug-sections $t/exe2 $t/exe3
+objcopy --dump-section .debug_info=$t/debug_info2 $t/exe3
+cmp $t/debug_info1 $t/debug_info2
+
+$CC -B. -o $t/exe4 $t/a.o -Wl,--compress-debug-sections=zlib-gnu
+$t/exe4 | grep -q 'Hello world 3'
+readelf -W --sections $t/exe4 | grep -q '\.zdebug_info'
+
+echo OK
@@ -0,0 +1,54 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -o $t/a.o -c -xc -
+#include <stdio.h>
+
+int main() {
+  printf("Hello world\n");
+  return 0;
+}
+EOF
+
+$CC -B. -o $t/exe1 $t/a.o
+$CC -B. -o $t/exe2 $t/a.o -Wl,--huge-pages -Wl,--perf > $t/log
+$t/exe2 | grep -q 'Hello world'
+cmp $t/exe1 $t/exe2
+grep -q ' copy_buf' $t/log
+
+# --perf reports dTLB misses if the hardware counter is available.
+cat <<EOF | $CC -o $t/perf-check -xc -
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main() {
+  struct perf_event_attr attr = {0};
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.size = sizeof(attr);
+  attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0) == -1;
+}
+EOF
+
+if $t/perf-check; then
+  grep -q 'Real    dTLB-miss  Name$' $t/log
+  grep -Eq '^ +[-0-9.]+ +[-0-9.]+ +[-0-9.]+ +[0-9]+ +copy_buf$' $t/log
+else
+  ! grep -q dTLB-miss $t/log || false
+fi
+
+echo OK
@@ -0,0 +1,63 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+which clang >& /dev/null || { echo skipped; exit 0; }
+
+cat <<EOF | clang -c -o $t/a.o -ffunction-sections -faddrsig -xc -
+#include <stdio.h>
+
+int foo1(int x) { return x * 7 + 1; }
+int foo2(int x) { return x * 7 + 1; }
+int foo3(int x) { return x * 7 + 1; }
+int foo4(int x) { return x * 7 + 1; }
+
+int main() {
+  printf("%d %d %d\n", foo1(1), foo2(2), (long)foo3 == (long)foo4);
+  return 0;
+}
+EOF
+
+$CC -B. -o $t/exe $t/a.o -Wl,-icf=safe -Wl,-print-icf-sections > $t/log
+$t/exe | grep -q '8 15 0'
+grep -q 'removing identical section .*(.text.foo[12])' $t/log
+! grep -q 'removing identical section .*(.text.foo[34])' $t/log || false
+
+$CC -B. -o $t/exe $t/a.o -Wl,-icf=all
+$t/exe | grep -q '8 15 1'
+
+# Sections in files without .llvm_addrsig are not folded.
+cat <<EOF | $CC -c -o $t/b.o -ffunction-sections -xc -
+int bar1(int x) { return x * 7 + 1; }
+int bar2(int x) { return x * 7 + 1; }
+EOF
+
+$CC -B. -o $t/exe $t/a.o $t/b.o -Wl,-icf=safe -Wl,-print-icf-sections > $t/log
+! grep -q 'removing identical section .*(.text.bar[12])' $t/log || false
+
+# Symbols referenced from files without .llvm_addrsig are not folded
+# even if they are defined in files with .llvm_addrsig.
+cat <<EOF | clang -c -o $t/c.o -ffunction-sections -faddrsig -xc -
+int baz1(int x) { return x * 7 + 1; }
+int baz2(int x) { return x * 7 + 1; }
+EOF
+
+cat <<EOF | $CC -c -o $t/d.o -xc -
+#include <stdio.h>
+int baz1(int);
+int baz2(int);
+int main() { printf("%d\n", baz1 == baz2); }
+EOF
+
+$CC -B. -o $t/exe $t/c.o $t/d.o -Wl,-icf=safe
+$t/exe | grep -q '^0$'
+
+echo OK
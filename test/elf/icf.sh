@@ -39,4 +39,25 @@ EOF
 $CC -B. -o $t/exe $t/a.o -Wl,-icf=all
 $t/exe | grep -q '1 0'
 
+# foo1 and foo2 are identical but call different functions,
+# so they must not be folded.
+cat <<EOF | $CC -c -o $t/b.o -O1 -ffunction-sections -fno-optimize-sibling-calls -xc -
+#include <stdio.h>
+
+__attribute__((noinline)) int bar1() { return 1; }
+__attribute__((noinline)) int bar2() { return 2; }
+__attribute__((noinline)) int baz1() { return bar1() + 1; }
+__attribute__((noinline)) int baz2() { return bar2() * 3; }
+__attribute__((noinline)) int foo1() { return baz1(); }
+__attribute__((noinline)) int foo2() { return baz2(); }
+
+int main() {
+  printf("%d %d\n", foo1(), foo2());
+  return 0;
+}
+EOF
+
+$CC -B. -o $t/exe $t/b.o -Wl,-icf=all
+$t/exe | grep -q '2 6'
+
 echo OK
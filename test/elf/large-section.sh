@@ -0,0 +1,31 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -o $t/a.o -c -xc -fdata-sections -
+char x1[3L << 30];
+char x2[3L << 30];
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+char x3[16];
+int main() { return 0; }
+EOF
+
+# We don't run the output because it needs 6 GiB of memory.
+$CC -B. -o $t/exe $t/a.o $t/b.o
+
+nm $t/exe > $t/log
+x1=$(grep ' x1$' $t/log | cut -d' ' -f1)
+x3=$(grep ' x3$' $t/log | cut -d' ' -f1)
+[ $((0x$x3 - 0x$x1)) -ge $((6 << 30)) ]
+
+echo OK
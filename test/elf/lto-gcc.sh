@@ -0,0 +1,52 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+echo 'int main() {}' | gcc -flto -o $t/exe -xc - >& /dev/null \
+  || { echo skipped; exit; }
+
+cat <<EOF | gcc -flto -O2 -c -o $t/a.o -xc -
+#include <stdio.h>
+int foo(int);
+int main() {
+  printf("%d\n", foo(3));
+  return 0;
+}
+EOF
+
+cat <<EOF | gcc -flto -O2 -fPIC -c -o $t/b.o -xc -
+int foo(int x) { return x * 7; }
+int bar() { return 1; }
+EOF
+
+cat <<EOF | gcc -flto -O2 -c -o $t/c.o -xc -
+int baz() { return 2; }
+EOF
+
+rm -f $t/c.a
+ar rcs $t/c.a $t/c.o
+
+gcc -B. -flto -O2 -o $t/exe $t/a.o $t/b.o $t/c.a
+$t/exe | grep -q '^21$'
+
+# foo is inlined, and bar and baz are not used.
+! nm $t/exe | grep -Eq ' (foo|bar|baz)$' || false
+
+# Exported symbols must be kept when creating a shared object.
+gcc -B. -flto -O2 -shared -o $t/c.so $t/b.o
+nm -D $t/c.so | grep -q ' T foo$'
+nm -D $t/c.so | grep -q ' T bar$'
+
+# An LTO object file requires --plugin.
+! ./mold -o $t/exe2 $t/a.o $t/b.o 2> $t/log || false
+grep -q 'no --plugin option was given' $t/log
+
+echo OK
@@ -0,0 +1,36 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+which clang >& /dev/null || { echo skipped; exit 0; }
+
+# clang passes LLVMgold.so to the linker via --plugin.
+echo 'int main() {}' | clang -B. -flto -o $t/exe -xc - >& /dev/null \
+  || { echo skipped; exit 0; }
+
+cat <<EOF | clang -flto -O2 -c -o $t/a.o -xc -
+#include <stdio.h>
+int foo(int);
+int main() {
+  printf("%d\n", foo(3));
+  return 0;
+}
+EOF
+
+cat <<EOF | clang -flto -O2 -c -o $t/b.o -xc -
+int foo(int x) { return x * 7; }
+EOF
+
+clang -B. -flto -O2 -o $t/exe $t/a.o $t/b.o
+$t/exe | grep -q '^21$'
+! nm $t/exe | grep -q ' foo$' || false
+
+echo OK
@@ -0,0 +1,50 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -c -o $t/a.o -xc -
+int foo() { return 3; }
+int main() { return foo(); }
+EOF
+
+cat <<EOF | $CC -c -o $t/b.o -xc -
+char bar[100] = {1};
+EOF
+
+rm -f $t/c.a
+ar rcs $t/c.a $t/b.o
+
+cat <<EOF | $CC -c -o $t/d.o -xc -
+extern char bar[];
+char *baz() { return bar; }
+EOF
+
+$CC -B. -o $t/exe $t/a.o $t/d.o $t/c.a \
+  -Wl,--Map=$t/map.json,--Map-format=json
+
+grep -q '"output_sections": \[' $t/map.json
+grep -q '{"name": "foo", "address": ' $t/map.json
+grep -q '{"file": ".*/c.a(b.o)", "archive": ".*/c.a", "size": 100}' $t/map.json
+grep -q '{"archive": ".*/c.a", "size": 100}' $t/map.json
+
+$CC -B. -o $t/exe $t/a.o $t/d.o $t/c.a \
+  -Wl,--Map=$t/map.csv,--Map-format=csv
+
+head -1 $t/map.csv | \
+  grep -q '^kind,address,size,align,output_section,file,input_section,symbol$'
+grep -q '^symbol,[0-9]*,,,.text,.*/a.o,.text,foo$' $t/map.csv
+grep -q '^file,,100,,,.*/c.a(b.o),,$' $t/map.csv
+grep -q '^archive,,100,,,.*/c.a,,$' $t/map.csv
+
+! $CC -B. -o $t/exe $t/a.o -Wl,--Map-format=xml 2> $t/log || false
+grep -q 'unknown --Map-format argument: xml' $t/log
+
+echo OK
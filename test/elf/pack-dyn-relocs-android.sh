@@ -0,0 +1,134 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+# A decoder for the Android packed relocation format (APS2). It prints
+# relocations in .android.rela.dyn as "offset type symbol addend".
+cat <<'EOF' | $CC -o $t/decode -xc -
+#include <elf.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static unsigned char *p;
+
+static long sleb() {
+  unsigned long val = 0;
+  int shift = 0;
+  unsigned char byte;
+  do {
+    byte = *p++;
+    if (shift < 64)
+      val |= (unsigned long)(byte & 0x7f) << shift;
+    shift += 7;
+  } while (byte & 0x80);
+  if (shift < 64 && (byte & 0x40))
+    val |= -(1UL << shift);
+  return val;
+}
+
+int main(int argc, char **argv) {
+  int fd = open(argv[1], O_RDONLY);
+  struct stat st;
+  fstat(fd, &st);
+  unsigned char *buf = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  Elf64_Ehdr *ehdr = (Elf64_Ehdr *)buf;
+  Elf64_Shdr *shdr = (Elf64_Shdr *)(buf + ehdr->e_shoff);
+
+  for (int i = 0; i < ehdr->e_shnum; i++) {
+    if (shdr[i].sh_type != 0x60000002)
+      continue;
+
+    Elf64_Sym *dynsym = (Elf64_Sym *)(buf + shdr[shdr[i].sh_link].sh_offset);
+    char *dynstr = (char *)buf + shdr[shdr[shdr[i].sh_link].sh_link].sh_offset;
+
+    p = buf + shdr[i].sh_offset;
+    if (memcmp(p, "APS2", 4))
+      return 1;
+    p += 4;
+
+    long count = sleb();
+    unsigned long offset = sleb();
+    unsigned long info = 0;
+    long addend = 0;
+
+    while (count > 0) {
+      long size = sleb();
+      long flags = sleb();
+      long delta = (flags & 2) ? sleb() : 0;
+      if (flags & 1)
+        info = sleb();
+      if ((flags & 8) && (flags & 4))
+        addend += sleb();
+      else if (!(flags & 8))
+        addend = 0;
+
+      for (long j = 0; j < size; j++) {
+        offset += (flags & 2) ? delta : sleb();
+        if (!(flags & 1))
+          info = sleb();
+        if ((flags & 8) && !(flags & 4))
+          addend += sleb();
+        printf("%016lx %lu %s %ld\n", offset, ELF64_R_TYPE(info),
+               dynstr + dynsym[ELF64_R_SYM(info)].st_name, addend);
+      }
+      count -= size;
+    }
+
+    if (count != 0 || p > buf + shdr[i].sh_offset + shdr[i].sh_size)
+      return 1;
+  }
+  return 0;
+}
+EOF
+
+cat <<EOF | $CC -fPIC -c -o $t/a.o -xc -
+extern int foo;
+extern int bar;
+
+int *p1 = &foo;
+int *p2 = &bar + 1;
+int *arr[] = { &foo, &bar, &foo, &bar, &foo };
+int *const crr[] = { &bar, &bar, &bar + 2, &foo };
+
+int get() { return foo + bar; }
+EOF
+
+$CC -B. -shared -o $t/b.so $t/a.o
+readelf -W --relocs $t/b.so | grep -Ec 'GLOB_DAT|R_X86_64_64' > $t/count
+
+$CC -B. -shared -o $t/b.so $t/a.o -Wl,--pack-dyn-relocs=android
+$t/decode $t/b.so > $t/log
+
+[ "$(wc -l < $t/log)" = "$(cat $t/count)" ]
+
+readelf -W --dyn-syms $t/b.so | grep -q ' foo$'
+readelf -W --dynamic $t/b.so | grep -q '0x0*60000011 '
+readelf -W --relocs $t/b.so | grep -Eq 'GLOB_DAT|R_X86_64_64' && false
+
+addr() {
+  nm $t/b.so | grep " $1\$" | cut -d' ' -f1
+}
+
+grep -q "^$(addr p1) 1 foo 0$" $t/log
+grep -q "^$(addr p2) 1 bar 4$" $t/log
+grep -q "^$(addr arr) 1 foo 0$" $t/log
+grep -q "^$(addr crr) 1 bar 0$" $t/log
+[ "$(grep -c ' 1 bar 8$' $t/log)" = 1 ]
+[ "$(grep -c ' 1 foo 0$' $t/log)" = 5 ]
+grep -q ' 6 foo 0$' $t/log
+grep -q ' 6 bar 0$' $t/log
+
+echo OK
@@ -0,0 +1,33 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CXX -c -o $t/a.o -xc++ -
+inline int foo() { return 3; }
+int bar() { return foo(); }
+EOF
+
+cat <<EOF | $CXX -c -o $t/b.o -xc++ -
+#include <stdio.h>
+inline int foo() { return 3; }
+int bar();
+int main() { printf("%d %d\n", foo(), bar()); }
+EOF
+
+"$mold" -r -o $t/c.o $t/a.o $t/b.o
+
+readelf -W --section-groups $t/c.o > $t/log
+[ "$(grep -c 'COMDAT group' $t/log)" = 1 ]
+
+$CXX -B. -o $t/exe $t/c.o
+$t/exe | grep -q '^3 3$'
+
+echo OK
@@ -41,6 +41,26 @@ EOF
 [ -f $t/c.o ]
 ! [ -x t/c.o ] || false
 
+# Symbol names are deduplicated in .strtab.
+cat <<EOF | $CC -c -o $t/e.o -xc -
+static int foo() { return 1; }
+int e() { return foo(); }
+EOF
+
+cat <<EOF | $CC -c -o $t/f.o -xc -
+static int foo() { return 2; }
+int f() { return foo(); }
+EOF
+
+cat <<EOF | $CC -c -o $t/g.o -xc -
+static int foo() { return 3; }
+int g() { return foo(); }
+EOF
+
+"$mold" --relocatable -o $t/h.o $t/e.o $t/f.o $t/g.o
+[ "$(readelf -W --symbols $t/h.o | grep -c ' foo$')" = 3 ]
+[ "$(readelf -W -p .strtab $t/h.o | grep -c '\] *foo$')" = 1 ]
+
 cat <<EOF | $CXX -c -o $t/d.o -xc++ -
 #include <iostream>
 
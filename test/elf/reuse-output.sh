@@ -0,0 +1,40 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -o $t/a.o -c -xc -
+#include <stdio.h>
+int main() {
+  printf("Hello world\n");
+}
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+#include <stdio.h>
+int main() {
+  printf("Hello mold\n");
+}
+EOF
+
+$CC -B. -o $t/exe $t/a.o
+$t/exe | grep -q 'Hello world'
+
+$CC -B. -o $t/exe $t/b.o -Wl,--reuse-output
+$t/exe | grep -q 'Hello mold'
+
+$CC -B. -o $t/exe2 $t/b.o
+cmp $t/exe $t/exe2
+
+$CC -B. -o $t/exe $t/b.o -Wl,--reuse-output -Wl,--stats > $t/log
+grep -q 'clean_pages' $t/log
+cmp $t/exe $t/exe2
+
+echo OK
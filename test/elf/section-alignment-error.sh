@@ -0,0 +1,35 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+[ "$(uname -m)" = x86_64 ] || { echo skipped; exit; }
+
+cat <<EOF | $CC -o $t/a.o -c -x assembler -
+  .globl _start
+  .text
+_start:
+  ret
+  .section .data.foo,"aw",@progbits
+  .balign 4
+  .long 1
+EOF
+
+# Rewrite sh_addralign of .data.foo to 12, which is not a power of two.
+shoff=$(readelf -h $t/a.o | awk '/Start of section headers/ {print $5}')
+idx=$(readelf -W -S $t/a.o | sed -n 's/^ *\[ *\([0-9]*\)\] \.data\.foo .*/\1/p')
+printf '\x0c\0\0\0\0\0\0\0' | \
+  dd of=$t/a.o bs=1 seek=$((shoff + idx * 64 + 48)) conv=notrunc 2> /dev/null
+readelf -W -S $t/a.o | grep -Eq '\.data\.foo .* 12$'
+
+! "$mold" -o $t/exe $t/a.o 2> $t/log || false
+grep -q 'a.o:(.data.foo): alignment is not a power of two' $t/log
+
+echo OK
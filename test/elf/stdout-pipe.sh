@@ -10,17 +10,26 @@ mold="$(pwd)/mold"
 t=out/test/elf/$testname
 mkdir -p $t
 
-which ld.bfd >& /dev/null || { echo skipped; exit 0; }
-
-cat <<EOF | gcc -flto -c -o $t/a.o -xc -
+cat <<EOF | $CC -fPIC -o $t/a.o -c -xc -
 #include <stdio.h>
+
 int main() {
   printf("Hello world\n");
+  return 0;
 }
 EOF
 
-gcc -B"$(pwd)" -o $t/exe $t/a.o >& $t/log
-grep -q 'falling back' $t/log
-$t/exe | grep -q 'Hello world'
+$CC -B. $t/a.o -o $t/exe1
+$t/exe1 | grep -q 'Hello world'
+
+$CC -B. $t/a.o -o - | cat > $t/exe2
+cmp $t/exe1 $t/exe2
+
+rm -f $t/fifo
+mkfifo $t/fifo
+cat $t/fifo > $t/exe3 &
+$CC -B. $t/a.o -o $t/fifo
+wait
+cmp $t/exe1 $t/exe3
 
 echo OK
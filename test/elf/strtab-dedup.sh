@@ -0,0 +1,50 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -o $t/a.o -c -x assembler -
+  .globl foo, this_is_a_long_global_symbol_name
+this_is_a_long_local_symbol_name:
+foo:
+this_is_a_long_global_symbol_name:
+  .byte 0
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -x assembler -
+  .globl bar
+this_is_a_long_local_symbol_name:
+bar:
+  .byte 0
+EOF
+
+cat <<EOF | $CC -o $t/c.o -c -x assembler -
+  .globl baz
+this_is_a_long_local_symbol_name:
+this_is_a_long_global_symbol_name:
+baz:
+  .byte 0
+EOF
+
+"$mold" -o $t/exe $t/a.o $t/b.o $t/c.o -e foo
+
+readelf -W --symbols $t/exe > $t/log
+[ "$(grep -c ' this_is_a_long_local_symbol_name$' $t/log)" = 3 ]
+grep -q ' this_is_a_long_global_symbol_name$' $t/log
+grep -q ' foo$' $t/log
+grep -q ' bar$' $t/log
+grep -q ' baz$' $t/log
+
+# Each name is stored only once in .strtab.
+readelf -p .strtab $t/exe > $t/log
+[ "$(grep -c ' this_is_a_long_local_symbol_name$' $t/log)" = 1 ]
+[ "$(grep -c ' this_is_a_long_global_symbol_name$' $t/log)" = 1 ]
+
+echo OK
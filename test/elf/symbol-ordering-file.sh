@@ -0,0 +1,58 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -o $t/a.o -c -xc -ffunction-sections -
+#include <stdio.h>
+
+void foo() { printf("foo "); }
+void bar() { printf("bar "); }
+static void baz() { printf("baz "); }
+void qux() { printf("qux "); }
+
+int main() {
+  foo();
+  bar();
+  baz();
+  qux();
+  printf("\n");
+  return 0;
+}
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -x assembler -
+  .globl abs_sym
+  .set abs_sym, 0x1234
+EOF
+
+cat <<EOF > $t/order
+# comment
+qux
+baz  # local symbol
+no_such_symbol
+abs_sym
+bar
+EOF
+
+$CC -B. -o $t/exe $t/a.o $t/b.o -Wl,--symbol-ordering-file=$t/order 2> $t/log
+$t/exe | grep -q 'foo bar baz qux'
+grep -q 'no such symbol: no_such_symbol' $t/log
+grep -q 'unable to order absolute symbol: abs_sym' $t/log
+! grep -q 'no such symbol: abs_sym' $t/log || false
+
+nm -n $t/exe | grep -E ' (foo|bar|baz|qux)$' | awk '{print $3}' | \
+  tr '\n' ' ' | grep -q '^qux baz bar foo $'
+
+$CC -B. -o $t/exe $t/a.o -Wl,--symbol-ordering-file=$t/order \
+  -Wl,--no-warn-symbol-ordering 2> $t/log
+! grep -q 'no such symbol' $t/log || false
+
+echo OK
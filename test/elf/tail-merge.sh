@@ -0,0 +1,48 @@
+#!/bin/bash
+export LANG=
+set -e
+CC="${CC:-cc}"
+CXX="${CXX:-c++}"
+testname=$(basename -s .sh "$0")
+echo -n "Testing $testname ... "
+cd "$(dirname "$0")"/../..
+mold="$(pwd)/mold"
+t=out/test/elf/$testname
+mkdir -p $t
+
+cat <<EOF | $CC -o $t/a.o -c -x assembler -
+  .section .rodata.str1.1,"aMS",@progbits,1
+a1: .string "abcdefghij0123"
+a2: .string "j0123"
+a3: .string "123"
+a4: .string "abcdefghij0124"
+
+  .data
+  .globl get
+get:
+  .quad a1, a2, a3, a4
+EOF
+
+cat <<EOF | $CC -o $t/b.o -c -xc -
+#include <stdio.h>
+
+extern char *get[];
+
+int main() {
+  printf("%s %s %s %s\n", get[0], get[1], get[2], get[3]);
+  return 0;
+}
+EOF
+
+$CC -B. -no-pie -o $t/exe1 $t/a.o $t/b.o
+$t/exe1 | grep -q '^abcdefghij0123 j0123 123 abcdefghij0124$'
+
+$CC -B. -no-pie -o $t/exe2 $t/a.o $t/b.o -Wl,-O2
+$t/exe2 | grep -q '^abcdefghij0123 j0123 123 abcdefghij0124$'
+
+readelf -p .rodata.str $t/exe1 | grep -q ' j0123$'
+! readelf -p .rodata.str $t/exe2 | grep -q ' j0123$' || false
+! readelf -p .rodata.str $t/exe2 | grep -q ' 123$' || false
+readelf -p .rodata.str $t/exe2 | grep -q 'abcdefghij0124$'
+
+echo OK